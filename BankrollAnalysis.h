@@ -0,0 +1,362 @@
+/*
+ * This class answers "how long does my bankroll last?" without simulating hands. It takes the exact per-round payout
+ * distribution (payout multiplier -> probability, e.g. from HandEval::standPatCounts or a strategy analysis) and works
+ * in whole bets, so one round moves the bankroll by (multiplier - 1) bets. There are two questions we can answer:
+ *
+ *   netAfter(n)        -> distribution of the net result after n rounds with no ruin barrier (unlimited credit). This is
+ *                         the n-fold convolution of the round's distribution, done by repeated squaring with FFTs.
+ *   ruinAfter(b, n)    -> the bankroll is an absorbing Markov chain: once it's below one bet the player is done. We
+ *                         step the chain n times and report the risk of ruin plus the bankroll distribution of the
+ *                         survivors. The round's kernel only has a handful of points so a direct sparse convolution
+ *                         per step is cheaper than an FFT here.
+ *
+ * Both trim probability mass below a tiny threshold off the tails to keep the vectors short, and report how much
+ * mass they dropped so the answer carries its own error bound.
+ */
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef MAP_H
+#define MAP_H
+#include <map>
+#endif
+
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef FSTREAM_H
+#define FSTREAM_H
+#include <fstream>
+#endif
+
+#ifndef SSTREAM_H
+#define SSTREAM_H
+#include <sstream>
+#endif
+
+#ifndef COMPLEX_H
+#define COMPLEX_H
+#include <complex>
+#endif
+
+#ifndef CMATH_H
+#define CMATH_H
+#include <cmath>
+#endif
+
+#include "HandEval.h"
+
+#ifndef BANKROLLANALYSIS_H
+#define BANKROLLANALYSIS_H
+
+class BankrollAnalysis {
+	public:
+		// probs[i] is the probability of being at (offset + i) bets. truncated is the mass trimmed off the tails.
+		struct Distribution {
+			long long offset{0};
+			std::vector<double> probs;
+			double truncated{0.0};
+			double mass() const;
+			double mean() const;
+			double stddev() const;
+			long long quantile(double p) const;
+		};
+		struct RuinResult {
+			double riskOfRuin{0.0};
+			Distribution survivors;  // bankroll in bets for the players that are still playing
+		};
+	private:
+		std::vector<double> kernel;  // kernel[i] = P(net change of i - 1 bets) for one round
+		double fftTrim{1e-15};        // FFT rounding noise sits around 1e-17, so don't trust anything much smaller
+		double stepTrim{1e-22};
+		static void fft(std::vector<std::complex<double>> &a, bool invert);
+		static std::vector<double> convolve(const std::vector<double> &a, const std::vector<double> &b);
+		static void trim(Distribution &d, double below);
+	public:
+		BankrollAnalysis(const std::map<int, double> &payouts);  // payouts have to pass checkPayouts()
+		static std::map<int, double> standPatPayouts();
+		static bool checkPayouts(const std::map<int, double> &payouts, std::string &error);
+		static bool loadPayouts(const std::string &path, std::map<int, double> &payouts, std::string &error);
+		double expectedReturn() const;
+		Distribution netAfter(long long rounds) const;
+		RuinResult ruinAfter(long long startingBets, long long rounds) const;
+};
+
+// ctor -> turn multiplier -> probability into a dense kernel over the net change in bets (index 0 is losing the bet)
+BankrollAnalysis::BankrollAnalysis(const std::map<int, double> &payouts) {
+	int maxMult = 0;
+	for (std::map<int, double>::const_iterator itr = payouts.begin(); itr != payouts.end(); ++itr) {
+		maxMult = std::max(maxMult, itr->first);
+	}
+	this->kernel.assign(maxMult + 1, 0.0);
+	for (std::map<int, double>::const_iterator itr = payouts.begin(); itr != payouts.end(); ++itr) {
+		this->kernel[itr->first] += itr->second;  // multiplier m nets m - 1 bets, which is index m
+	}
+}
+
+// standPatPayouts -> exact distribution for a player who never draws, straight from enumerating every hand
+std::map<int, double> BankrollAnalysis::standPatPayouts() {
+	long long counts[HandEval::NUM_CATEGORIES];
+	HandEval::standPatCounts(counts);
+	long long total = 0;
+	for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+		total += counts[c];
+	}
+	std::map<int, double> payouts;
+	for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+		payouts[HandEval::payout(c)] += double(counts[c]) / total;
+	}
+	return payouts;
+}
+
+// checkPayouts -> a payout distribution we can work with: no negative multipliers, every probability a finite number
+// that isn't negative, and all of them adding up to 1
+bool BankrollAnalysis::checkPayouts(const std::map<int, double> &payouts, std::string &error) {
+	double total = 0.0;
+	for (std::map<int, double>::const_iterator itr = payouts.begin(); itr != payouts.end(); ++itr) {
+		if (itr->first < 0) {
+			error = "multiplier " + std::to_string(itr->first) + " is negative";
+			return false;
+		}
+		if (!std::isfinite(itr->second) or itr->second < 0) {
+			error = "multiplier " + std::to_string(itr->first) + " has a bad probability";
+			return false;
+		}
+		total += itr->second;
+	}
+	if (payouts.empty() or std::fabs(total - 1.0) > 1e-9) {
+		std::ostringstream msg;
+		msg << "probabilities add up to " << total << " instead of 1";
+		error = msg.str();
+		return false;
+	}
+	return true;
+}
+
+// loadPayouts -> read "multiplier probability" lines (what rtp --payouts writes) and check them. Blank lines are fine,
+// anything else that isn't exactly one such pair is an error.
+bool BankrollAnalysis::loadPayouts(const std::string &path, std::map<int, double> &payouts, std::string &error) {
+	std::ifstream in(path);
+	if (!in) {
+		error = "can't open " + path;
+		return false;
+	}
+	payouts.clear();
+	std::string line;
+	for (int number = 1; std::getline(in, line); ++number) {
+		std::istringstream fields(line);
+		int mult;
+		double prob;
+		std::string extra;
+		if (!(fields >> mult)) {
+			if (line.find_first_not_of(" \t\r") == std::string::npos) {
+				continue;
+			}
+		}
+		else if (fields >> prob and !(fields >> extra)) {
+			payouts[mult] += prob;
+			continue;
+		}
+		error = path + " line " + std::to_string(number) + " isn't a \"multiplier probability\" pair";
+		return false;
+	}
+	if (!checkPayouts(payouts, error)) {
+		error = path + ": " + error;
+		return false;
+	}
+	return true;
+}
+
+// expectedReturn -> average payout per unit bet (1.0 would be a fair game)
+double BankrollAnalysis::expectedReturn() const {
+	double ret = 0.0;
+	for (std::size_t m = 0; m < this->kernel.size(); ++m) {
+		ret += m * this->kernel[m];
+	}
+	return ret;
+}
+
+// fft -> in place iterative radix-2 transform. The size has to be a power of 2.
+void BankrollAnalysis::fft(std::vector<std::complex<double>> &a, bool invert) {
+	const std::size_t n = a.size();
+	for (std::size_t i = 1, j = 0; i < n; ++i) {  // bit reversal permutation
+		std::size_t bit = n >> 1;
+		for (; j & bit; bit >>= 1) {
+			j ^= bit;
+		}
+		j ^= bit;
+		if (i < j) {
+			std::swap(a[i], a[j]);
+		}
+	}
+	const double pi = std::acos(-1.0);
+	for (std::size_t len = 2; len <= n; len <<= 1) {
+		double ang = 2 * pi / len * (invert ? -1 : 1);
+		std::complex<double> wlen(std::cos(ang), std::sin(ang));
+		for (std::size_t i = 0; i < n; i += len) {
+			std::complex<double> w(1);
+			for (std::size_t j = 0; j < len / 2; ++j) {
+				std::complex<double> u = a[i + j], v = a[i + j + len / 2] * w;
+				a[i + j] = u + v;
+				a[i + j + len / 2] = u - v;
+				w *= wlen;
+			}
+		}
+	}
+	if (invert) {
+		for (std::size_t i = 0; i < n; ++i) {
+			a[i] /= double(n);
+		}
+	}
+}
+
+// convolve -> direct when one side is short (cheaper and exact), FFT otherwise. FFT noise can come out slightly
+// negative so we clamp at 0.
+std::vector<double> BankrollAnalysis::convolve(const std::vector<double> &a, const std::vector<double> &b) {
+	std::vector<double> out(a.size() + b.size() - 1, 0.0);
+	if (std::min(a.size(), b.size()) <= 64) {
+		for (std::size_t i = 0; i < a.size(); ++i) {
+			for (std::size_t j = 0; j < b.size(); ++j) {
+				out[i + j] += a[i] * b[j];
+			}
+		}
+		return out;
+	}
+	std::size_t n = 1;
+	while (n < out.size()) {
+		n <<= 1;
+	}
+	std::vector<std::complex<double>> fa(a.begin(), a.end()), fb(b.begin(), b.end());
+	fa.resize(n);
+	fb.resize(n);
+	fft(fa, false);
+	fft(fb, false);
+	for (std::size_t i = 0; i < n; ++i) {
+		fa[i] *= fb[i];
+	}
+	fft(fa, true);
+	for (std::size_t i = 0; i < out.size(); ++i) {
+		out[i] = std::max(0.0, fa[i].real());
+	}
+	return out;
+}
+
+// trim -> drop the tails below the threshold and keep track of how much we threw away
+void BankrollAnalysis::trim(Distribution &d, double below) {
+	std::size_t first = 0, last = d.probs.size();
+	while (first < last and d.probs[first] < below) {
+		d.truncated += d.probs[first++];
+	}
+	while (last > first and d.probs[last - 1] < below) {
+		d.truncated += d.probs[--last];
+	}
+	d.probs.erase(d.probs.begin() + last, d.probs.end());
+	d.probs.erase(d.probs.begin(), d.probs.begin() + first);
+	d.offset += first;
+}
+
+// netAfter -> n-fold convolution by repeated squaring: O(log n) FFT convolutions instead of n steps
+BankrollAnalysis::Distribution BankrollAnalysis::netAfter(long long rounds) const {
+	Distribution result, power;
+	result.probs.assign(1, 1.0);
+	power.offset = -1;
+	power.probs = this->kernel;
+	while (rounds > 0) {
+		if (rounds & 1) {
+			result.probs = convolve(result.probs, power.probs);
+			result.offset += power.offset;
+			result.truncated += power.truncated;
+			trim(result, this->fftTrim);
+		}
+		rounds >>= 1;
+		if (rounds > 0) {
+			power.probs = convolve(power.probs, power.probs);
+			power.offset *= 2;
+			power.truncated *= 2;
+			trim(power, this->fftTrim);
+		}
+	}
+	return result;
+}
+
+// ruinAfter -> step the absorbing chain. A bankroll of 0 bets can't cover the next round so that mass is ruined.
+BankrollAnalysis::RuinResult BankrollAnalysis::ruinAfter(long long startingBets, long long rounds) const {
+	RuinResult result;
+	if (startingBets <= 0) {
+		result.riskOfRuin = 1.0;
+		return result;
+	}
+	Distribution &cur = result.survivors;
+	cur.offset = startingBets;
+	cur.probs.assign(1, 1.0);
+	std::vector<double> next;
+	for (long long t = 0; t < rounds and !cur.probs.empty(); ++t) {
+		next.assign(cur.probs.size() + this->kernel.size() - 1, 0.0);
+		const std::size_t width = cur.probs.size();
+		const double *in = cur.probs.data();
+		for (std::size_t k = 0; k < this->kernel.size(); ++k) {  // one axpy per outcome so the inner loop vectorizes
+			const double q = this->kernel[k];
+			if (q == 0.0) {
+				continue;
+			}
+			double *out = next.data() + k;
+			for (std::size_t i = 0; i < width; ++i) {
+				out[i] += q * in[i];
+			}
+		}
+		cur.probs.swap(next);
+		cur.offset -= 1;
+		std::size_t dead = 0;
+		while (dead < cur.probs.size() and cur.offset + (long long)dead <= 0) {
+			result.riskOfRuin += cur.probs[dead++];
+		}
+		cur.probs.erase(cur.probs.begin(), cur.probs.begin() + dead);
+		cur.offset += dead;
+		trim(cur, this->stepTrim);
+	}
+	return result;
+}
+
+double BankrollAnalysis::Distribution::mass() const {
+	double total = 0.0;
+	for (std::size_t i = 0; i < this->probs.size(); ++i) {
+		total += this->probs[i];
+	}
+	return total;
+}
+
+// mean -> conditional on the mass that's in the distribution
+double BankrollAnalysis::Distribution::mean() const {
+	double total = 0.0, m = mass();
+	for (std::size_t i = 0; i < this->probs.size(); ++i) {
+		total += (this->offset + (long long)i) * this->probs[i];
+	}
+	return m > 0 ? total / m : 0.0;
+}
+
+double BankrollAnalysis::Distribution::stddev() const {
+	double mu = mean(), total = 0.0, m = mass();
+	for (std::size_t i = 0; i < this->probs.size(); ++i) {
+		double x = this->offset + (long long)i - mu;
+		total += x * x * this->probs[i];
+	}
+	return m > 0 ? std::sqrt(total / m) : 0.0;
+}
+
+// quantile -> smallest value whose cumulative (normalized) probability reaches p
+long long BankrollAnalysis::Distribution::quantile(double p) const {
+	double m = mass(), running = 0.0;
+	for (std::size_t i = 0; i < this->probs.size(); ++i) {
+		running += this->probs[i];
+		if (running >= p * m) {
+			return this->offset + i;
+		}
+	}
+	return this->offset + (long long)this->probs.size() - 1;
+}
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ * Small helpers for the compact binary files the tools write (shard checkpoints, session snapshots). A BinaryWriter
+ * appends fixed width fields to a buffer and a BinaryReader reads them back in the same order, failing instead of reading
+ * past the end. Numbers are written in the machine's byte order (little endian on everything we run on). checksum()
+ * is 64 bit FNV-1a, which is plenty to catch a torn or corrupted file.
+ */
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef CSTRING_H
+#define CSTRING_H
+#include <cstring>
+#endif
+
+#ifndef FSTREAM_H
+#define FSTREAM_H
+#include <fstream>
+#endif
+
+#ifndef ITERATOR_H
+#define ITERATOR_H
+#include <iterator>
+#endif
+
+#ifndef CSTDIO_H
+#define CSTDIO_H
+#include <cstdio>
+#endif
+
+#ifndef BINARYIO_H
+#define BINARYIO_H
+
+class BinaryWriter {
+	private:
+		std::string buf;
+	public:
+		template <typename T>
+		void put(T value) { this->buf.append(reinterpret_cast<const char*>(&value), sizeof(T)); }
+		void putBytes(const void *data, std::size_t size) { this->buf.append(static_cast<const char*>(data), size); }
+		void putString(const std::string &s);
+		void putChecksum();
+		const std::string& data() const { return this->buf; }
+		bool saveAtomically(const std::string &path) const;
+};
+
+class BinaryReader {
+	private:
+		const char *data;
+		std::size_t size;
+		std::size_t pos{0};
+		bool good{true};
+	public:
+		BinaryReader(const std::string &buf): data(buf.data()), size(buf.size()) {}
+		BinaryReader(const char *d, std::size_t n): data(d), size(n) {}
+		template <typename T>
+		T get();
+		bool getBytes(void *out, std::size_t n);
+		std::string getString();
+		bool verifyChecksum();
+		bool ok() const { return this->good; }
+		std::size_t offset() const { return this->pos; }
+};
+
+// checksum -> 64 bit FNV-1a
+unsigned long long checksum(const char *data, std::size_t size) {
+	unsigned long long h = 14695981039346656037ULL;
+	for (std::size_t i = 0; i < size; ++i) {
+		h ^= (unsigned char)data[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+// readFile -> whole file into a string. Returns false if it can't be opened.
+bool readFile(const std::string &path, std::string &out) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in) {
+		return false;
+	}
+	out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	return true;
+}
+
+// putString -> length prefixed
+void BinaryWriter::putString(const std::string &s) {
+	put<unsigned>(s.size());
+	this->buf.append(s);
+}
+
+// putChecksum -> checksum of everything written so far, goes last
+void BinaryWriter::putChecksum() {
+	put<unsigned long long>(checksum(this->buf.data(), this->buf.size()));
+}
+
+// saveAtomically -> write to a temp file and rename it over the old one, so a kill mid-write leaves the previous file
+bool BinaryWriter::saveAtomically(const std::string &path) const {
+	std::string tmp = path + ".tmp";
+	{
+		std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+		out.write(this->buf.data(), this->buf.size());
+		out.flush();
+		if (!out) {
+			return false;
+		}
+	}
+	return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+template <typename T>
+T BinaryReader::get() {
+	T value = T();
+	getBytes(&value, sizeof(T));
+	return value;
+}
+
+bool BinaryReader::getBytes(void *out, std::size_t n) {
+	if (!this->good or this->size - this->pos < n) {
+		this->good = false;
+		return false;
+	}
+	std::memcpy(out, this->data + this->pos, n);
+	this->pos += n;
+	return true;
+}
+
+std::string BinaryReader::getString() {
+	unsigned n = get<unsigned>();
+	if (!this->good or this->size - this->pos < n) {
+		this->good = false;
+		return std::string();
+	}
+	std::string s(this->data + this->pos, n);
+	this->pos += n;
+	return s;
+}
+
+// verifyChecksum -> the next 8 bytes have to match the checksum of everything before them
+bool BinaryReader::verifyChecksum() {
+	unsigned long long expected = checksum(this->data, this->pos);
+	return get<unsigned long long>() == expected and this->good;
+}
+
+#endif
@@ -27,8 +27,8 @@ class Card {
 		std::string cardSuit; 
 	public: 
 		Card(std::string val, std::string s): cardValue(val), cardSuit(s) {};  // ctor 
-		std::string getCardSuit() const {return this->cardSuit;}
-		std::string getCardValue() const {return this->cardValue;}
+		const std::string& getCardSuit() const {return this->cardSuit;}
+		const std::string& getCardValue() const {return this->cardValue;}
 		void display(); 
 };
 
@@ -0,0 +1,236 @@
+/*
+ * This class takes the shuffle off of the Game's critical path. A background producer thread keeps drawing 10-card
+ * deal sequences (5 cards for the hand and up to 5 replacements) and pushes them into a lock-free single-producer/
+ * single-consumer ring buffer. The Game then pops a ready deal in O(1) with nextDeal(). If the ring fills up, the
+ * producer sleeps until there's room (back-pressure) so it never runs away from the game, and if the ring is empty the
+ * consumer sleeps until the producer catches up. Pushing and popping stay lock-free; the mutex and condition variables
+ * are only touched when one side has to sleep or the other side has to wake it. Since there's only one producer drawing
+ * in order, a seeded stream is fully reproducible.
+ * Each game thread should own its own DealStream so that both ends of the ring stay single-threaded.
+ */
+#ifndef ATOMIC_H
+#define ATOMIC_H
+#include <atomic>
+#endif
+
+#ifndef THREAD_H
+#define THREAD_H
+#include <thread>
+#endif
+
+#ifndef MUTEX_H
+#define MUTEX_H
+#include <mutex>
+#endif
+
+#ifndef CONDITION_VARIABLE_H
+#define CONDITION_VARIABLE_H
+#include <condition_variable>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef RANDOM_H
+#define RANDOM_H
+#include <random>
+#endif
+
+#ifndef CHRONO_H
+#define CHRONO_H
+#include <chrono>
+#endif
+
+#ifndef DEALSTREAM_H
+#define DEALSTREAM_H
+
+// A deal is the order the top 10 cards come off the deck. Cards are ids from 0-51 in the same order the Deck ctor
+// builds them (suit-major), so Deck::stack() can turn them back into Cards.
+struct Deal {
+	static const int size = 10;
+	int cards[size];
+};
+
+// Fixed size ring buffer for exactly one pushing thread and one popping thread. The capacity is rounded up to a power
+// of 2 so that we can mask instead of mod. The head and tail live on separate cache lines so that the producer and
+// consumer don't keep stealing the line from each other.
+template <typename T>
+class RingBuffer {
+	private:
+		std::vector<T> slots;
+		std::size_t mask;
+		alignas(64) std::atomic<std::size_t> head{0};  // next slot to pop (only written by the consumer)
+		alignas(64) std::atomic<std::size_t> tail{0};  // next slot to push (only written by the producer)
+	public:
+		explicit RingBuffer(std::size_t capacity);
+		bool tryPush(const T &item);
+		bool tryPop(T &item);
+		std::size_t capacity() const { return this->slots.size(); }
+		std::size_t size() const { return this->tail.load(std::memory_order_acquire) - this->head.load(std::memory_order_acquire); }
+};
+
+// ctor -> round the requested capacity up to the next power of 2
+template <typename T>
+RingBuffer<T>::RingBuffer(std::size_t capacity) {
+	std::size_t size = 2;
+	while (size < capacity) {
+		size <<= 1;
+	}
+	this->slots.resize(size);
+	this->mask = size - 1;
+}
+
+// tryPush -> returns false if the ring is full. The release store on tail publishes the slot to the consumer.
+template <typename T>
+bool RingBuffer<T>::tryPush(const T &item) {
+	std::size_t t = this->tail.load(std::memory_order_relaxed);
+	if (t - this->head.load(std::memory_order_acquire) == this->slots.size()) {
+		return false;
+	}
+	this->slots[t & this->mask] = item;
+	this->tail.store(t + 1, std::memory_order_release);
+	return true;
+}
+
+// tryPop -> returns false if the ring is empty. The release store on head hands the slot back to the producer.
+template <typename T>
+bool RingBuffer<T>::tryPop(T &item) {
+	std::size_t h = this->head.load(std::memory_order_relaxed);
+	if (h == this->tail.load(std::memory_order_acquire)) {
+		return false;
+	}
+	item = this->slots[h & this->mask];
+	this->head.store(h + 1, std::memory_order_release);
+	return true;
+}
+
+
+class DealStream {
+	private:
+		RingBuffer<Deal> ring;
+		std::mt19937_64 rng;
+		int order[52]; 				// producer's working deck, shuffled in place a little more on every deal
+		std::atomic<bool> running{true};
+		std::mutex sleepLock;                      // only held to go to sleep or to wake the other side
+		std::condition_variable roomCv, dealCv;
+		std::atomic<bool> producerAsleep{false}, consumerAsleep{false};
+		std::thread producer;
+		int drawBelow(int n);
+		void produce();
+		bool roomToRefill() const { return this->ring.size() <= this->ring.capacity() / 2; }
+		void wake(std::atomic<bool> &asleep, std::condition_variable &cv, bool ready);
+	public:
+		DealStream(std::size_t capacity = 1024); 		// time seeded, like Deck::shuffle()
+		DealStream(std::size_t capacity, unsigned long long seed);  // reproducible stream
+		~DealStream();
+		DealStream(const DealStream&) = delete;
+		DealStream& operator=(const DealStream&) = delete;
+		Deal nextDeal();
+		bool tryNextDeal(Deal &deal);
+};
+
+// ctor -> seed on the current time the same way the Deck does
+DealStream::DealStream(std::size_t capacity): DealStream(capacity, std::chrono::system_clock::now().time_since_epoch().count()) {}
+
+// ctor -> seeded. The producer thread is started last so that everything it touches is already set up.
+DealStream::DealStream(std::size_t capacity, unsigned long long seed): ring(capacity), rng(seed) {
+	for (int i = 0; i < 52; ++i) {
+		this->order[i] = i;
+	}
+	this->producer = std::thread(&DealStream::produce, this);
+}
+
+// dtor -> stop the producer and wait for it (it may be asleep on a full ring)
+DealStream::~DealStream() {
+	this->running.store(false);
+	{
+		std::lock_guard<std::mutex> l(this->sleepLock);
+		this->roomCv.notify_all();
+	}
+	this->producer.join();
+}
+
+// wake -> after a push or pop, wake the other side if it went to sleep and what it's waiting for is there. The fence
+// pairs with the one a sleeper does between raising its flag and looking at the ring, so either we see the flag or it
+// sees our push/pop.
+void DealStream::wake(std::atomic<bool> &asleep, std::condition_variable &cv, bool ready) {
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (ready and asleep.load(std::memory_order_relaxed)) {
+		std::lock_guard<std::mutex> l(this->sleepLock);
+		cv.notify_one();
+	}
+}
+
+// drawBelow -> unbiased number in [0, n). We throw away the top sliver of the engine's range that doesn't divide
+// evenly by n. Doing it by hand (instead of uniform_int_distribution) keeps seeded streams identical across compilers.
+int DealStream::drawBelow(int n) {
+	const unsigned long long range = std::mt19937_64::max();
+	const unsigned long long limit = range - (range % n + 1) % n;
+	unsigned long long r;
+	do {
+		r = this->rng();
+	} while (r > limit);
+	return r % n;
+}
+
+// produce -> only the first 10 steps of a Fisher-Yates shuffle are needed for 10 cards, so a deal costs 10 draws
+// instead of a full 52 card shuffle. When the ring is full we sleep until the game has taken half of it, so a game that
+// takes one deal at a time doesn't wake us for every single deal.
+void DealStream::produce() {
+	Deal deal;
+	while (this->running.load(std::memory_order_relaxed)) {
+		for (int i = 0; i < Deal::size; ++i) {
+			int j = i + drawBelow(52 - i);
+			std::swap(this->order[i], this->order[j]);
+			deal.cards[i] = this->order[i];
+		}
+		while (!this->ring.tryPush(deal)) {
+			std::unique_lock<std::mutex> l(this->sleepLock);
+			this->producerAsleep.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			this->roomCv.wait(l, [this] {
+				return !this->running.load() or roomToRefill();
+			});
+			this->producerAsleep.store(false, std::memory_order_relaxed);
+			if (!this->running.load()) {
+				return;
+			}
+		}
+		wake(this->consumerAsleep, this->dealCv, true);
+	}
+}
+
+// nextDeal -> pop the next ready deal. If the producer has fallen behind we give it a few turns first (it's usually
+// in the middle of a deal) and only then sleep until it pushes one.
+Deal DealStream::nextDeal() {
+	Deal deal;
+	bool popped = this->ring.tryPop(deal);
+	for (int spin = 0; spin < 64 and !popped; ++spin) {
+		std::this_thread::yield();
+		popped = this->ring.tryPop(deal);
+	}
+	while (!popped) {
+		std::unique_lock<std::mutex> l(this->sleepLock);
+		this->consumerAsleep.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		this->dealCv.wait(l, [this] { return this->ring.size() > 0; });
+		this->consumerAsleep.store(false, std::memory_order_relaxed);
+		l.unlock();
+		popped = this->ring.tryPop(deal);
+	}
+	wake(this->producerAsleep, this->roomCv, roomToRefill());
+	return deal;
+}
+
+// tryNextDeal -> pop a deal if one is ready, without waiting
+bool DealStream::tryNextDeal(Deal &deal) {
+	if (!this->ring.tryPop(deal)) {
+		return false;
+	}
+	wake(this->producerAsleep, this->roomCv, roomToRefill());
+	return true;
+}
+
+#endif
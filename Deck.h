@@ -45,11 +45,16 @@ class Deck {
 		std::vector<Card> dealtCards; 
 	public:
 		Deck();
+		friend class SessionSnapshot;  // saves and restores the card order 
 		Card deal();
 		void shuffle(); 
+		void shuffle(unsigned seed); 
 		int countRemaining() { return this->deck.size(); } 
 		std::deque<Card> getDeck() {return this->deck;}
 		void resetDeck(); 
+		void stack(const int *ids, int count);
+		static int cardId(const Card &c);
+		static const Card& card(int id);
 		void display() ;
 };
 		
@@ -77,7 +82,12 @@ Card Deck::deal() {
 // using a C++ way of shuffling cards based on the current time as the seed for our RNG 
 void Deck::shuffle() {
 	unsigned rd = std::chrono::system_clock::now().time_since_epoch().count();  // get a seed based on time right now
-       	auto rng = std::default_random_engine{rd}; 
+	shuffle(rd); 
+}
+
+// the same shuffle with a given seed, so a shuffle can be replayed (the shuffle audit checks itself against this) 
+void Deck::shuffle(unsigned seed) {
+       	auto rng = std::default_random_engine{seed}; 
 	std::shuffle(std::begin(this->deck), std::end(this->deck), rng);	
 }
 
@@ -87,7 +97,42 @@ void Deck::resetDeck() {
 		for (int i = 0; i < dealtCards.size(); ++i) {
 			deck.push_back(dealtCards[i]);   // adding back the dealt cards back into our deck 
 		}
+		dealtCards.clear();  // otherwise the same cards get added back again on the next reset
+		dealt = false;
+	}
+}
+
+// stack the deck from a pre-drawn deal (see DealStream). All 52 cards go back in the deck and the given card ids 
+// (0-51, in the same suit-major order the ctor uses) get swapped to the top so the next deal() calls hand them out in 
+// order. Only those cards move, the rest of the deck stays where it is since a round never gets that deep. 
+void Deck::stack(const int *ids, int count) {
+	resetDeck();
+	int where[52];  // where[id] = position of that card in the deck 
+	for (std::size_t i = 0; i < this->deck.size(); ++i) {
+		where[cardId(this->deck[i])] = i;
 	}
+	for (int i = 0; i < count; ++i) {
+		int from = where[ids[i]];
+		std::swap(this->deck[i], this->deck[from]);
+		where[cardId(this->deck[from])] = from;
+		where[ids[i]] = i;
+	}
+}
+
+// cardId -> the id (0-51) of one of the Deck's own cards. They're only ever spelled the way the ctor spells them, 
+// so the first letters are enough (HandEval::cardId takes any capitalization but is a lot slower). 
+int Deck::cardId(const Card &c) {
+	const std::string &val = c.getCardValue(), &s = c.getCardSuit();
+	int suit = s[0] == 'H' ? 0 : s[0] == 'C' ? 1 : s[0] == 'S' ? 2 : 3;
+	int rank = val[0] == 'A' ? 0 : val[0] == 'J' ? 10 : val[0] == 'Q' ? 11 : val[0] == 'K' ? 12 :
+		val.size() == 2 ? 9 : val[0] - '1';
+	return suit * 13 + rank;
+}
+
+// card -> the card with this id, out of a fresh deck that's built once 
+const Card& Deck::card(int id) {
+	static const std::deque<Card> fresh = Deck().getDeck();
+	return fresh[id];
 }
 
 // display function to see all the remaining cards in the deck
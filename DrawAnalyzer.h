@@ -0,0 +1,223 @@
+/*
+ * This class does the exact math behind a draw. For a dealt hand and any of the 32 ways to hold its cards, it counts how
+ * many of the possible draws end in each hand category -- without going through the draws. The trick is a table that
+ * says, for every set X of 0 to 5 cards, how many 5 card hands of each category contain X. The hands we can finish with
+ * after holding H are the ones that contain H and none of the discards, which inclusion-exclusion over the discards gets
+ * out of the table in 32 lookups for all 32 holds at once.
+ *
+ * Everything stays in integers so results can be added up and compared exactly. A hold's value is its expected payout
+ * multiplied by `scale` (the least common multiple of C(47, k) for k = 0-5), which is always a whole number.
+ *
+ * The table is about 115 MB and every worker reads all over it. Built with a pool, each worker zeroes an equal stripe of
+ * it first, so first touch spreads its pages over the workers' NUMA nodes instead of putting all of them on one.
+ */
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef ALGORITHM_H
+#define ALGORITHM_H
+#include <algorithm>
+#endif
+
+#ifndef MEMORY_H
+#define MEMORY_H
+#include <memory>
+#endif
+
+#include "HandEval.h"
+#include "WorkStealingPool.h"
+
+#ifndef DRAWANALYZER_H
+#define DRAWANALYZER_H
+
+class DrawAnalyzer {
+	public:
+		static const long long numDeals = 2598960;  // C(52, 5)
+		static const long long scale = 7669695;     // lcm(C(47, 0), ..., C(47, 5))
+		static const int numHolds = 32;
+		struct HoldResult {
+			long long counts[HandEval::NUM_CATEGORIES];  // draws that end in each category
+			long long draws;                             // C(47, cards drawn)
+			long long value;                             // expected payout * scale
+		};
+	private:
+		std::unique_ptr<unsigned[]> table;  // table[subsetIndex * NUM_CATEGORIES + category]
+		int pay[HandEval::NUM_CATEGORIES];
+		static long long binom[53][6];
+		static long long offsets[6];
+		static void initBinomials();
+		static long long subsetIndex(const int sorted[], int count);
+	public:
+		DrawAnalyzer();                                         // the game's own payouts
+		DrawAnalyzer(const int payouts[HandEval::NUM_CATEGORIES], WorkStealingPool *pool = nullptr);
+		void analyze(const int hand[5], HoldResult results[numHolds]) const;
+		int bestHold(const HoldResult results[numHolds]) const;
+		int payout(int category) const { return this->pay[category]; }
+		static long long choose(int n, int k) { initBinomials(); return binom[n][k]; }
+		static void unrankDeal(long long index, int hand[5]);
+		static bool nextDeal(int hand[5]);
+};
+
+long long DrawAnalyzer::binom[53][6];
+long long DrawAnalyzer::offsets[6];
+
+// initBinomials -> fill the tables once. A function local static is thread safe to initialize, so workers can call this.
+void DrawAnalyzer::initBinomials() {
+	static const bool ready = []() {
+		for (int n = 0; n <= 52; ++n) {
+			binom[n][0] = 1;
+			for (int k = 1; k <= 5; ++k) {
+				binom[n][k] = n == 0 ? 0 : binom[n - 1][k - 1] + binom[n - 1][k];
+			}
+		}
+		offsets[0] = 0;
+		for (int k = 1; k <= 5; ++k) {
+			offsets[k] = offsets[k - 1] + binom[52][k - 1];
+		}
+		return true;
+	}();
+	(void)ready;
+}
+
+// subsetIndex -> every subset size gets its own block and within it the cards' colex rank
+long long DrawAnalyzer::subsetIndex(const int sorted[], int count) {
+	long long idx = offsets[count];
+	for (int i = 0; i < count; ++i) {
+		idx += binom[sorted[i]][i + 1];
+	}
+	return idx;
+}
+
+DrawAnalyzer::DrawAnalyzer(): DrawAnalyzer(nullptr) {}
+
+// ctor -> every 5 card hand adds one to the row of each of its 32 subsets (about 83 million increments). The table is
+// allocated without zeroing it (so none of its pages are touched yet) and then zeroed by the pool's workers, if any.
+DrawAnalyzer::DrawAnalyzer(const int payouts[HandEval::NUM_CATEGORIES], WorkStealingPool *pool) {
+	initBinomials();
+	for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+		this->pay[c] = payouts != nullptr ? payouts[c] : HandEval::payout(c);
+	}
+	const long long size = (offsets[5] + binom[52][5]) * HandEval::NUM_CATEGORIES;
+	this->table.reset(new unsigned[size]);
+	unsigned *t = this->table.get();
+	if (pool != nullptr) {
+		const long long parts = pool->size();
+		pool->runOnEach([t, size, parts](int worker) {
+			std::fill(t + size * worker / parts, t + size * (worker + 1) / parts, 0u);
+		});
+	}
+	else {
+		std::fill(t, t + size, 0u);
+	}
+	int h[5], subset[5];
+	for (h[0] = 0; h[0] < 52; ++h[0])
+	for (h[1] = h[0] + 1; h[1] < 52; ++h[1])
+	for (h[2] = h[1] + 1; h[2] < 52; ++h[2])
+	for (h[3] = h[2] + 1; h[3] < 52; ++h[3])
+	for (h[4] = h[3] + 1; h[4] < 52; ++h[4]) {
+		int cat = HandEval::category(h);
+		for (int mask = 0; mask < numHolds; ++mask) {
+			int count = 0;
+			for (int i = 0; i < 5; ++i) {
+				if (mask >> i & 1) {
+					subset[count++] = h[i];
+				}
+			}
+			++this->table[subsetIndex(subset, count) * HandEval::NUM_CATEGORIES + cat];
+		}
+	}
+}
+
+// analyze -> fill in all 32 holds. Bit i of a hold keeps hand[i], whatever order the hand is in.
+void DrawAnalyzer::analyze(const int hand[5], HoldResult results[numHolds]) const {
+	int pos[5] = {0, 1, 2, 3, 4}, sorted[5], subset[5];
+	std::sort(pos, pos + 5, [hand](int a, int b) { return hand[a] < hand[b]; });
+	for (int i = 0; i < 5; ++i) {
+		sorted[i] = hand[pos[i]];
+	}
+	// f[mask] starts as "hands containing these cards" and after the superset Mobius transform is "hands containing
+	// these cards and none of the other dealt cards", i.e. the possible results of holding them
+	long long f[numHolds][HandEval::NUM_CATEGORIES];
+	for (int mask = 0; mask < numHolds; ++mask) {
+		int count = 0;
+		for (int i = 0; i < 5; ++i) {
+			if (mask >> i & 1) {
+				subset[count++] = sorted[i];
+			}
+		}
+		const unsigned *row = &this->table[subsetIndex(subset, count) * HandEval::NUM_CATEGORIES];
+		for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+			f[mask][c] = row[c];
+		}
+	}
+	for (int bit = 0; bit < 5; ++bit) {
+		for (int mask = 0; mask < numHolds; ++mask) {
+			if (!(mask >> bit & 1)) {
+				for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+					f[mask][c] -= f[mask | 1 << bit][c];
+				}
+			}
+		}
+	}
+	for (int mask = 0; mask < numHolds; ++mask) {
+		int hold = 0, held = 0;  // same hold in terms of the caller's card positions
+		for (int i = 0; i < 5; ++i) {
+			if (mask >> i & 1) {
+				hold |= 1 << pos[i];
+				++held;
+			}
+		}
+		HoldResult &r = results[hold];
+		r.draws = binom[47][5 - held];
+		long long total = 0;
+		for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+			r.counts[c] = f[mask][c];
+			total += this->pay[c] * f[mask][c];
+		}
+		r.value = total * (scale / r.draws);
+	}
+}
+
+// bestHold -> the hold with the highest expected payout (the first one on a tie)
+int DrawAnalyzer::bestHold(const HoldResult results[numHolds]) const {
+	int best = 0;
+	for (int hold = 1; hold < numHolds; ++hold) {
+		if (results[hold].value > results[best].value) {
+			best = hold;
+		}
+	}
+	return best;
+}
+
+// unrankDeal -> the index-th 5 card hand in colex order, ascending card ids. Index goes from 0 to numDeals - 1.
+void DrawAnalyzer::unrankDeal(long long index, int hand[5]) {
+	initBinomials();
+	int card = 51;
+	for (int k = 5; k >= 1; --k) {
+		while (binom[card][k] > index) {
+			--card;
+		}
+		hand[k - 1] = card;
+		index -= binom[card][k];
+		--card;
+	}
+}
+
+// nextDeal -> step to the next hand in colex order. Returns false after the last one.
+bool DrawAnalyzer::nextDeal(int hand[5]) {
+	for (int i = 0; i < 5; ++i) {
+		int limit = i == 4 ? 52 : hand[i + 1];
+		if (hand[i] + 1 < limit) {
+			++hand[i];
+			for (int j = 0; j < i; ++j) {
+				hand[j] = j;
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+#endif
@@ -22,24 +22,42 @@
 #include "Card.h"
 #include "Deck.h"
 #include "PokerHand.h" 
+#include "DealStream.h"
+#include "Jackpot.h"
 
 class Game {
+	public:
+		enum Phase { BETTING, BET_PLACED, DEALT, DRAWN };  // where the current round is (see SessionSnapshot) 
 	private: 
 		Player* p1; 
 		Deck* deck; 
+		DealStream* stream{nullptr};  // optional source of pre-shuffled deals 
+		Jackpot* jackpot{nullptr};    // optional progressive jackpot shared with other sessions 
 		std::vector<Card> currHand; 
 		const int handSize{5}; 
-		int deposit; 
-		int bet; 
+		int deposit{0}; 
+		int bet{0}; 
 		bool play{true}; 
+		int phase{BETTING}; 
+		void showHand(); 
+		void playRounds(); 
 	public:
 		Game(Player* p, Deck* d): p1(p), deck(d) {}; 
+		Game(Player* p, Deck* d, DealStream* s): p1(p), deck(d), stream(s) {}; 
+		friend class SessionSnapshot; 
+		void setJackpot(Jackpot* j) { this->jackpot = j; } 
+		void setStream(DealStream* s) { this->stream = s; } 
+		int getPhase() const { return this->phase; } 
 		void executeDeposit();
 		void executeBet(); 
+		bool placeBet(int); 
 		void dealHand(); 
+		void dealCards(); 
+		void drawCards(const std::vector<int>&); 
 		std::vector<int> getCardids(); // helper function for dealHand()
 		void evaluateHand();
 		void startGame();
+		void resumeGame();
 		void endGame();
 		void continuePlay();
 };
@@ -48,6 +66,11 @@ class Game {
 // long as the the play boolean variable is true. Once it's false, the player will cashout. 
 void Game::startGame() {
 	executeDeposit();
+	playRounds(); 
+}
+
+// playRounds -> the rounds after the first deposit, until the player cashes out 
+void Game::playRounds() {
 	while (this->play) { 
 		executeBet();
 		dealHand();
@@ -57,6 +80,25 @@ void Game::startGame() {
 	p1->cashout(); 
 }
 
+// resumeGame -> pick a restored session (see SessionSnapshot) back up wherever its round was, then keep playing as usual. 
+// The bankroll was already deposited before the snapshot so there's no first deposit here. 
+void Game::resumeGame() {
+	if (this->phase == BET_PLACED) {
+		dealCards(); 
+	}
+	else if (this->phase == DEALT) {
+		showHand(); 
+	}
+	if (this->phase == DEALT) {
+		drawCards(getCardids()); 
+	}
+	if (this->phase == DRAWN) {
+		evaluateHand(); 
+		continuePlay(); 
+	}
+	playRounds(); 
+}
+
 
 // This function allows for the continuation of the Game after the bets and evaluations are done. The user will have to 
 // input a 1 to keep playing. If he does, then he will be prompted to make a deposit as well to his bankroll. 
@@ -110,16 +152,33 @@ void Game::executeDeposit() {
 // If so, then the player has to make another deposit to replenish the bankroll. 
 void Game::executeBet() {
 	bool valid_bet = false;
+	int someBet = 0; 
 	while (!valid_bet) {
 		std::cout << "Enter a bet!" << std::endl; 
-		std::cin >> bet; 
-		valid_bet = p1->makeBet(this->bet); 
-		if (valid_bet == false && (this->bet >= 1 && this->bet < 5)){
+		std::cin >> someBet; 
+		valid_bet = placeBet(someBet); 
+		if (valid_bet && this->jackpot != nullptr) {
+			std::cout << "Progressive jackpot: " << this->jackpot->currentPot() << " coins" << std::endl; 
+		}
+		if (valid_bet == false && (someBet >= 1 && someBet < 5)){
 			executeDeposit(); 
 		}
 	}
 }
 
+// placeBet -> take the bet out of the bankroll if it's valid and start the round. Returns false if it isn't. 
+bool Game::placeBet(int someBet) {
+	if (!p1->makeBet(someBet)) {
+		return false; 
+	}
+	this->bet = someBet; 
+	this->phase = BET_PLACED; 
+	if (this->jackpot != nullptr) {
+		this->jackpot->contribute(this->bet);  // part of every bet feeds the progressive pot 
+	}
+	return true; 
+}
+
 
 //  This is a helper function to get user input as a stream of integers. These integers will match 
 //  the Card numbers that will be displayed to stdout so the user will have to match the cards he wants to replace. 
@@ -141,21 +200,44 @@ std::vector<int> Game::getCardids() {
 	return cardIDsToReplace; 
 }
 
-// This function makes a new hand based on the cards that the player wants to replace. 
+// This function makes a new hand based on the cards that the player wants to replace. The deal and the draw are 
+// separate steps so a session can be snapshotted (and restored) in between. 
 void Game::dealHand() {
-	deck->resetDeck();
-	deck->shuffle(); 	
+	dealCards(); 
+	drawCards(getCardids());  // return result from helper function above 
+}
+
+// dealCards -> deal the first 5 cards and show them. If the Game was given a DealStream, the shuffling was already 
+// done in the background and we just stack the deck. 
+void Game::dealCards() {
+	if (this->stream != nullptr) {
+		Deal next = this->stream->nextDeal(); 
+		deck->stack(next.cards, Deal::size); 
+	}
+	else {
+		deck->resetDeck();
+		deck->shuffle(); 	
+	}
 	for (int i = 0; i < handSize; ++i) {
 		this->currHand.push_back(deck->deal()); 
 	}
+	this->phase = DEALT; 
+	showHand(); 
+}
+
+// showHand -> display the dealt cards numbered 1-5 for the player to pick from 
+void Game::showHand() {
 	std::cout << "Here are your cards. Choose the #s of the cards you would like to replace" << std::endl; 
 	for (int i = 0; i < handSize; ++i) {
 		std::cout << "Card #" << i+1 << "->";
 		this->currHand[i].display(); 
 	}
 	std::cout << "\n" << std::endl; 
+}
+
+// drawCards -> replace the cards with the given #s (1-5) from the deck 
+void Game::drawCards(const std::vector<int>& cardIDsToReplace) {
 	std::vector<int> replaced;   // will hold the ids of the cards to replace 
-	std::vector<int> cardIDsToReplace= getCardids(); // return result from helper function above 
 	std::vector<Card> tempHand;  
 	// dangerous to "erase" while iterating so we create a temporary hand that has all the currHand's cards.
 	// We will then clear the currHand and add new cards for each replaced ID that's detected. 
@@ -168,7 +250,8 @@ void Game::dealHand() {
 	for (int i = 0; i < cardIDsToReplace.size(); ++i) {
 		num = cardIDsToReplace[i]; 
 		--num; // because player will see x from 1-5 instead of 0-4 which we need for indexing 
-		if (num <= 4 and num >= 0) {
+		// a # entered twice only gets replaced once, otherwise the hand would end up with too many cards 
+		if (num <= 4 and num >= 0 and std::find(replaced.begin(), replaced.end(), num) == replaced.end()) {
 			std::cout << "replacing card id " << num+1 << std::endl; 
 			this->currHand.push_back(deck->deal());  // add new cards for each "replaced" that's detected 
 			replaced.push_back(num); 
@@ -187,6 +270,7 @@ void Game::dealHand() {
 			this->currHand.push_back(tempHand[itr->first]); 
 		}
 	}
+	this->phase = DRAWN; 
 	std::cout << "\nNew hand: " << std::endl;
 	for (int i = 0; i < handSize; ++i) {
 		this->currHand[i].display(); 
@@ -195,7 +279,7 @@ void Game::dealHand() {
 
 // This function evaluates the current Hand with the Poker game rules of scoring hands. 
 // Any winnings will be reflected in the bankroll. A clear display is shown and then the hand is erased for
-// the next game. 
+// the next game. With a jackpot set, a royal flush wins the progressive pot instead of the usual 250 to 1. 
 void Game::evaluateHand() {
 	PokerHand phand(this->currHand); 
 	bool winHand = phand.evalJacksOrBetter(); // will evaluate every possible hand 
@@ -203,8 +287,16 @@ void Game::evaluateHand() {
 	if (winHand) {
 		payMult = phand.getPayoutMult(); 
 		int winnings = payMult * this->bet;  // get the winnings and add it back to our player 
+		unsigned long long hit = 0; 
+		if (this->jackpot != nullptr && payMult == PokerHand::royalFlushMult) {
+			winnings = this->jackpot->claim(p1->getName(), &hit);  // progressive mode: the royal flush takes the whole pot 
+			std::cout << "JACKPOT! "; 
+		}
 		std::cout << "you won " << winnings << " coins" << std::endl; 
 		p1->addWinnings(winnings); 
+		if (hit != 0) {
+			this->jackpot->credited(hit);  // lets the jackpot's books show the pot reached a bankroll 
+		}
 		std::cout << std::endl;
 	}
 	else {
@@ -213,5 +305,6 @@ void Game::evaluateHand() {
 	p1->display(); 
 	std::cout << std::endl; 
 	this->currHand.clear();  		// we're done with the hand so we can clear it 
+	this->phase = BETTING; 
 }
 
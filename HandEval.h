@@ -0,0 +1,134 @@
+/*
+ * This class is the fast, quiet counterpart to PokerHand for the analysis tools. Instead of strings it works on card
+ * ids from 0-51 in the same suit-major order the Deck ctor builds them (id / 13 is the suit and id % 13 is the rank with
+ * 0 = Ace, 9 = 10, 10 = Jack, 11 = Queen, 12 = King), and it scores a hand with one pass over rank counts. The
+ * categories and payouts are the same ones PokerHand uses (see the Scoring section of the README).
+ */
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef CTYPE_H
+#define CTYPE_H
+#include <cctype>
+#endif
+
+#ifndef ALGORITHM_H
+#define ALGORITHM_H
+#include <algorithm>
+#endif
+
+#include "Card.h"
+
+#ifndef HANDEVAL_H
+#define HANDEVAL_H
+
+class HandEval {
+	public:
+		enum Category { NOTHING, JACKS_OR_BETTER, TWO_PAIR, THREE_KIND, STRAIGHT, FLUSH, FULL_HOUSE, FOUR_KIND,
+			STRAIGHT_FLUSH, ROYAL_FLUSH, NUM_CATEGORIES };
+		static const int numCards = 52;
+		static const int numRanks = 13;
+		static const int royalMask = (1 << 0) | (1 << 9) | (1 << 10) | (1 << 11) | (1 << 12);  // 10, J, Q, K, A
+		static int rank(int id) { return id % numRanks; }
+		static int suit(int id) { return id / numRanks; }
+		static bool isStraight(int rankMask);
+		static int category(const int ids[5]);
+		static int payout(int category);
+		static const char* name(int category);
+		static int cardId(const Card &c);
+		static void standPatCounts(long long counts[NUM_CATEGORIES]);
+};
+
+// isStraight -> 5 distinct ranks in a row. The ace plays low (A-2-3-4-5) or high (10-J-Q-K-A).
+bool HandEval::isStraight(int rankMask) {
+	if (rankMask == royalMask) {
+		return true;
+	}
+	for (int low = 0; low + 5 <= numRanks; ++low) {
+		if (rankMask == (0x1F << low)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// category -> score a 5 card hand. The number of distinct ranks tells us which family we're in so we only ever
+// look at the counts we need.
+int HandEval::category(const int ids[5]) {
+	int counts[numRanks] = {0};
+	int rankMask = 0, distinct = 0, maxCount = 0;
+	bool flush = true;
+	for (int i = 0; i < 5; ++i) {
+		int r = rank(ids[i]);
+		if (counts[r] == 0) {
+			++distinct;
+		}
+		maxCount = std::max(maxCount, ++counts[r]);
+		rankMask |= 1 << r;
+		if (suit(ids[i]) != suit(ids[0])) {
+			flush = false;
+		}
+	}
+	if (distinct == 5) {
+		bool straight = isStraight(rankMask);
+		if (flush and rankMask == royalMask) return ROYAL_FLUSH;
+		if (flush and straight) return STRAIGHT_FLUSH;
+		if (flush) return FLUSH;
+		if (straight) return STRAIGHT;
+		return NOTHING;
+	}
+	if (distinct == 2) {
+		return maxCount == 4 ? FOUR_KIND : FULL_HOUSE;
+	}
+	if (distinct == 3) {
+		return maxCount == 3 ? THREE_KIND : TWO_PAIR;
+	}
+	// exactly one pair -> only pays if it's Jacks or better (ace, jack, queen, king)
+	for (int r = 0; r < numRanks; ++r) {
+		if (counts[r] == 2) {
+			return (r == 0 or r >= 10) ? JACKS_OR_BETTER : NOTHING;
+		}
+	}
+	return NOTHING;
+}
+
+// payout -> multiplier of the bet for each category, the same numbers PokerHand sets
+int HandEval::payout(int category) {
+	static const int multipliers[NUM_CATEGORIES] = {0, 1, 2, 3, 4, 6, 9, 25, 50, 250};
+	return multipliers[category];
+}
+
+const char* HandEval::name(int category) {
+	static const char* names[NUM_CATEGORIES] = {"Nothing", "Jacks or Better", "Two Pair", "Three of a Kind",
+		"Straight", "Flush", "Full House", "Four of a Kind", "Straight Flush", "Royal Flush"};
+	return names[category];
+}
+
+// cardId -> map a Card back to its id. Case doesn't matter since PokerHand lowercases its cards.
+int HandEval::cardId(const Card &c) {
+	static const std::string suits[4] = {"hearts", "clubs", "spades", "diamonds"};
+	static const std::string values[numRanks] = {"ace", "2", "3", "4", "5", "6", "7", "8", "9", "10", "jack", "queen", "king"};
+	std::string val = c.getCardValue(), s = c.getCardSuit();
+	std::transform(val.begin(), val.end(), val.begin(), ::tolower);
+	std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+	int suitIdx = std::find(suits, suits + 4, s) - suits;
+	int rankIdx = std::find(values, values + numRanks, val) - values;
+	return suitIdx * numRanks + rankIdx;
+}
+
+// standPatCounts -> exact number of the 2,598,960 possible 5 card hands that land in each category
+void HandEval::standPatCounts(long long counts[NUM_CATEGORIES]) {
+	std::fill(counts, counts + NUM_CATEGORIES, 0LL);
+	int h[5];
+	for (h[0] = 0; h[0] < numCards; ++h[0])
+	for (h[1] = h[0] + 1; h[1] < numCards; ++h[1])
+	for (h[2] = h[1] + 1; h[2] < numCards; ++h[2])
+	for (h[3] = h[2] + 1; h[3] < numCards; ++h[3])
+	for (h[4] = h[3] + 1; h[4] < numCards; ++h[4]) {
+		++counts[category(h)];
+	}
+}
+
+#endif
@@ -0,0 +1,278 @@
+/*
+ * A hold policy is a strategy chart: an ordered list of rules like "high pair", "4 to a flush" or "2 high cards". For a
+ * dealt hand the first rule that some of the cards fit decides the hold, and a hand that no rule fits throws all five
+ * back. A rule describes exactly the cards to hold, so "low pair" on a hand with two pair holds just the low pair -- list
+ * "two pair" first, the same way the printed charts do.
+ *
+ * Policy files have one rule per line, most important first. Blank lines and anything after a '#' are ignored, and
+ * "hold 4 to a flush over low pair" is the same as those two rules on two lines. When several holds fit one rule (2 high
+ * cards out of 3, say) the one with the highest cards wins. The rules are the Pattern names below plus a few aliases
+ * ("pair", "4 to a straight", "discard all", ...). Every possible hold is also sorted into the first pattern it fits,
+ * which is how the grader names the holds it compares.
+ */
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef FSTREAM_H
+#define FSTREAM_H
+#include <fstream>
+#endif
+
+#ifndef SSTREAM_H
+#define SSTREAM_H
+#include <sstream>
+#endif
+
+#include "HandEval.h"
+
+#ifndef HOLDPOLICY_H
+#define HOLDPOLICY_H
+
+class HoldPolicy {
+	public:
+		enum Pattern { ROYAL_FLUSH, STRAIGHT_FLUSH, FOUR_KIND, FULL_HOUSE, FLUSH, STRAIGHT, THREE_KIND, TWO_PAIR,
+			HIGH_PAIR, LOW_PAIR, FOUR_TO_ROYAL, FOUR_TO_STRAIGHT_FLUSH, FOUR_TO_FLUSH, FOUR_TO_OUTSIDE_STRAIGHT,
+			FOUR_TO_INSIDE_STRAIGHT, THREE_TO_ROYAL, THREE_TO_STRAIGHT_FLUSH, THREE_TO_FLUSH, FOUR_HIGH, THREE_HIGH,
+			THREE_TO_STRAIGHT, TWO_TO_ROYAL, TWO_TO_STRAIGHT_FLUSH, TWO_TO_FLUSH, TWO_HIGH, ONE_HIGH, NOTHING,
+			NUM_PATTERNS };
+		typedef unsigned long long PatternSet;  // bit p set means the hold fits pattern p
+		static const int numHolds = 32;
+		struct Rule {
+			std::string text;
+			PatternSet patterns;
+		};
+	private:
+		std::vector<Rule> rules;
+		static PatternSet bit(int pattern) { return 1ULL << pattern; }
+		static PatternSet classify(const int held[], int count);
+		static int highScore(const int hand[5], int hold);
+	public:
+		static const char* name(int pattern);
+		static bool parseRule(const std::string &text, PatternSet &patterns);
+		static void classifyHolds(const int hand[5], PatternSet sets[numHolds]);
+		static int holdClass(PatternSet set);
+		bool load(const std::string &path, std::string &error);
+		bool parse(std::istream &in, std::string &error);
+		int choose(const int hand[5], const PatternSet sets[numHolds], int &fired) const;
+		std::size_t size() const { return this->rules.size(); }
+		const Rule& rule(std::size_t i) const { return this->rules[i]; }
+};
+
+const char* HoldPolicy::name(int pattern) {
+	static const char* names[NUM_PATTERNS + 1] = {"royal flush", "straight flush", "four of a kind", "full house",
+		"flush", "straight", "three of a kind", "two pair", "high pair", "low pair", "4 to a royal",
+		"4 to a straight flush", "4 to a flush", "4 to an outside straight", "4 to an inside straight", "3 to a royal",
+		"3 to a straight flush", "3 to a flush", "4 high cards", "3 high cards", "3 to a straight", "2 to a royal",
+		"2 to a straight flush", "2 to a flush", "2 high cards", "high card", "nothing", "other"};
+	return names[pattern < 0 or pattern > NUM_PATTERNS ? NUM_PATTERNS : pattern];
+}
+
+// parseRule -> a rule's text to the patterns it stands for. Case, extra spaces and a leading "always", "hold", "keep"
+// or "any" don't matter. Returns false if it isn't a rule we know.
+bool HoldPolicy::parseRule(const std::string &text, PatternSet &patterns) {
+	std::istringstream words(text);
+	std::string word, rule;
+	while (words >> word) {
+		std::transform(word.begin(), word.end(), word.begin(), ::tolower);
+		if (rule.empty() and (word == "always" or word == "hold" or word == "keep" or word == "any")) {
+			continue;
+		}
+		rule += (rule.empty() ? "" : " ") + word;
+	}
+	const std::string toRoyalFlush = " to a royal flush";
+	if (rule.size() > toRoyalFlush.size() and rule.find(toRoyalFlush) == rule.size() - toRoyalFlush.size()) {
+		rule.erase(rule.size() - 6);  // "4 to a royal flush" -> "4 to a royal"
+	}
+	patterns = 0;
+	if (rule == "pair") patterns = bit(HIGH_PAIR) | bit(LOW_PAIR);
+	else if (rule == "4 to a straight") patterns = bit(FOUR_TO_OUTSIDE_STRAIGHT) | bit(FOUR_TO_INSIDE_STRAIGHT);
+	else if (rule == "royal") patterns = bit(ROYAL_FLUSH);
+	else if (rule == "quads") patterns = bit(FOUR_KIND);
+	else if (rule == "trips") patterns = bit(THREE_KIND);
+	else if (rule == "1 high card") patterns = bit(ONE_HIGH);
+	else if (rule == "discard all" or rule == "draw 5") patterns = bit(NOTHING);
+	for (int p = 0; p < NUM_PATTERNS and patterns == 0; ++p) {
+		if (rule == name(p)) {
+			patterns = bit(p);
+		}
+	}
+	return patterns != 0;
+}
+
+// classify -> every pattern the held cards fit. A hold has to be exactly the pattern: a pair plus a kicker isn't "pair".
+// A made hand fits every made hand it includes, so a royal is also a straight flush, a flush and a straight.
+HoldPolicy::PatternSet HoldPolicy::classify(const int held[], int count) {
+	if (count == 0) {
+		return bit(NOTHING);
+	}
+	int rankCounts[HandEval::numRanks] = {0}, rankMask = 0, highs = 0, distinct = 0;
+	bool suited = true;
+	for (int i = 0; i < count; ++i) {
+		int r = HandEval::rank(held[i]);
+		distinct += rankCounts[r]++ == 0;
+		rankMask |= 1 << r;
+		highs += r == 0 or r >= 10;
+		suited = suited and HandEval::suit(held[i]) == HandEval::suit(held[0]);
+	}
+	PatternSet s = 0;
+	if (count == 5) {
+		switch (HandEval::category(held)) {
+			case HandEval::ROYAL_FLUSH: s |= bit(ROYAL_FLUSH) | bit(STRAIGHT_FLUSH) | bit(FLUSH) | bit(STRAIGHT); break;
+			case HandEval::STRAIGHT_FLUSH: s |= bit(STRAIGHT_FLUSH) | bit(FLUSH) | bit(STRAIGHT); break;
+			case HandEval::FOUR_KIND: s |= bit(FOUR_KIND); break;  // the kicker changes nothing
+			case HandEval::FULL_HOUSE: s |= bit(FULL_HOUSE); break;
+			case HandEval::FLUSH: s |= bit(FLUSH); break;
+			case HandEval::STRAIGHT: s |= bit(STRAIGHT); break;
+		}
+		return s;
+	}
+	if (distinct == 1) {
+		if (count == 4) return bit(FOUR_KIND);
+		if (count == 3) return bit(THREE_KIND);
+		if (count == 2) return bit(highs == 2 ? HIGH_PAIR : LOW_PAIR);
+	}
+	if (count == 4 and distinct == 2 and rankCounts[HandEval::rank(held[0])] == 2) {
+		return bit(TWO_PAIR);
+	}
+	if (distinct != count) {
+		return 0;
+	}
+	bool royal = (rankMask & ~HandEval::royalMask) == 0, straight = royal, outside = false;
+	for (int low = 0; low + 5 <= HandEval::numRanks; ++low) {
+		straight = straight or (rankMask & ~(0x1F << low)) == 0;
+		outside = outside or (low >= 1 and rankMask == 0xF << low);  // open at both ends, so not A-2-3-4 or J-Q-K-A
+	}
+	outside = outside or rankMask == 0xF << 9;  // 10-J-Q-K
+	if (count >= 2 and suited) {
+		const int toRoyal[5] = {0, 0, TWO_TO_ROYAL, THREE_TO_ROYAL, FOUR_TO_ROYAL};
+		const int toStraightFlush[5] = {0, 0, TWO_TO_STRAIGHT_FLUSH, THREE_TO_STRAIGHT_FLUSH, FOUR_TO_STRAIGHT_FLUSH};
+		const int toFlush[5] = {0, 0, TWO_TO_FLUSH, THREE_TO_FLUSH, FOUR_TO_FLUSH};
+		s |= royal ? bit(toRoyal[count]) : 0;
+		s |= straight ? bit(toStraightFlush[count]) : 0;
+		s |= bit(toFlush[count]);
+	}
+	if (count == 4 and straight) {
+		s |= bit(outside ? FOUR_TO_OUTSIDE_STRAIGHT : FOUR_TO_INSIDE_STRAIGHT);
+	}
+	if (count == 3 and straight) {
+		s |= bit(THREE_TO_STRAIGHT);
+	}
+	if (highs == count) {
+		const int high[5] = {0, ONE_HIGH, TWO_HIGH, THREE_HIGH, FOUR_HIGH};
+		s |= bit(high[count]);
+	}
+	return s;
+}
+
+// classifyHolds -> the patterns for all 32 holds of a hand. Bit i of a hold keeps hand[i].
+void HoldPolicy::classifyHolds(const int hand[5], PatternSet sets[numHolds]) {
+	int held[5];
+	for (int hold = 0; hold < numHolds; ++hold) {
+		int count = 0;
+		for (int i = 0; i < 5; ++i) {
+			if (hold >> i & 1) {
+				held[count++] = hand[i];
+			}
+		}
+		sets[hold] = classify(held, count);
+	}
+}
+
+// holdClass -> the first pattern a hold fits, or NUM_PATTERNS ("other") if it doesn't fit any
+int HoldPolicy::holdClass(PatternSet set) {
+	for (int p = 0; p < NUM_PATTERNS; ++p) {
+		if (set >> p & 1) {
+			return p;
+		}
+	}
+	return NUM_PATTERNS;
+}
+
+// highScore -> how high the held cards are, aces high. Used to break ties between holds that fit the same rule.
+int HoldPolicy::highScore(const int hand[5], int hold) {
+	int score = 0;
+	for (int i = 0; i < 5; ++i) {
+		if (hold >> i & 1) {
+			int r = HandEval::rank(hand[i]);
+			score += r == 0 ? 13 : r;
+		}
+	}
+	return score;
+}
+
+bool HoldPolicy::load(const std::string &path, std::string &error) {
+	std::ifstream in(path);
+	if (!in) {
+		error = "can't open " + path;
+		return false;
+	}
+	if (!parse(in, error)) {
+		error = path + ": " + error;
+		return false;
+	}
+	return true;
+}
+
+// parse -> read the rules, splitting "a over b" into a then b
+bool HoldPolicy::parse(std::istream &in, std::string &error) {
+	std::string line;
+	for (int lineNo = 1; std::getline(in, line); ++lineNo) {
+		line = line.substr(0, line.find('#'));
+		std::size_t start = 0;
+		while (true) {
+			std::size_t over = line.find(" over ", start);
+			std::string text = line.substr(start, over == std::string::npos ? std::string::npos : over - start);
+			Rule r;
+			std::size_t first = text.find_first_not_of(" \t\r"), last = text.find_last_not_of(" \t\r");
+			r.text = first == std::string::npos ? "" : text.substr(first, last - first + 1);
+			if (!r.text.empty()) {
+				if (!parseRule(r.text, r.patterns)) {
+					error = "line " + std::to_string(lineNo) + ": don't know the rule \"" + r.text + "\"";
+					return false;
+				}
+				this->rules.push_back(r);
+			}
+			if (over == std::string::npos) {
+				break;
+			}
+			start = over + 6;
+		}
+	}
+	if (this->rules.empty()) {
+		error = "no rules";
+		return false;
+	}
+	return true;
+}
+
+// choose -> the hold for a hand whose 32 holds were classified with classifyHolds. fired is the index of the rule
+// that decided it, or size() when no rule fit and everything gets thrown back.
+int HoldPolicy::choose(const int hand[5], const PatternSet sets[numHolds], int &fired) const {
+	for (std::size_t r = 0; r < this->rules.size(); ++r) {
+		int best = -1, bestScore = -1;
+		for (int hold = 0; hold < numHolds; ++hold) {
+			if (sets[hold] & this->rules[r].patterns) {
+				int score = highScore(hand, hold);
+				if (score > bestScore) {
+					best = hold;
+					bestScore = score;
+				}
+			}
+		}
+		if (best >= 0) {
+			fired = r;
+			return best;
+		}
+	}
+	fired = this->rules.size();
+	return 0;
+}
+
+#endif
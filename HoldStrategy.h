@@ -0,0 +1,105 @@
+/*
+ * A hold strategy decides which of the 5 dealt cards to keep before the draw. It looks at card ids (see HandEval.h) and
+ * returns a 5 bit mask where bit i set means hold card i, the same thing the player does by hand in Game::dealHand by
+ * typing in the cards to replace. These are a few simple built-in strategies for the analysis tools to compare.
+ */
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#include "HandEval.h"
+
+#ifndef HOLDSTRATEGY_H
+#define HOLDSTRATEGY_H
+
+class HoldStrategy {
+	public:
+		typedef int (*Rule)(const int hand[5]);
+		static const int holdAll = 31;
+		static int standPat(const int hand[5]) { return holdAll; }
+		static int discardAll(const int hand[5]) { return 0; }
+		static int simple(const int hand[5]);
+		static int royalChaser(const int hand[5]);
+		static int toRoyal(const int hand[5], int atLeast);
+		static Rule byName(const std::string &name);
+};
+
+// toRoyal -> mask of the cards to a royal flush in the hand's best suit, if there are at least atLeast of them
+int HoldStrategy::toRoyal(const int hand[5], int atLeast) {
+	for (int s = 0; s < 4; ++s) {
+		int mask = 0, count = 0;
+		for (int i = 0; i < 5; ++i) {
+			if (HandEval::suit(hand[i]) == s and (HandEval::royalMask >> HandEval::rank(hand[i]) & 1)) {
+				mask |= 1 << i;
+				++count;
+			}
+		}
+		if (count >= atLeast) {
+			return mask;
+		}
+	}
+	return -1;
+}
+
+// simple -> keep made hands, then 4 to a royal, then any pairs/trips, then 4 to a flush, then Jacks or better high
+// cards. Otherwise throw everything back.
+int HoldStrategy::simple(const int hand[5]) {
+	int cat = HandEval::category(hand);
+	if (cat >= HandEval::STRAIGHT) {
+		return holdAll;
+	}
+	int royal = toRoyal(hand, 4);
+	if (royal >= 0) {
+		return royal;
+	}
+	int counts[HandEval::numRanks] = {0}, suits[4] = {0};
+	for (int i = 0; i < 5; ++i) {
+		++counts[HandEval::rank(hand[i])];
+		++suits[HandEval::suit(hand[i])];
+	}
+	int mask = 0;
+	for (int i = 0; i < 5; ++i) {  // pairs, two pair and trips all come down to keeping the matched ranks
+		if (counts[HandEval::rank(hand[i])] >= 2) {
+			mask |= 1 << i;
+		}
+	}
+	if (mask != 0) {
+		return mask;
+	}
+	for (int i = 0; i < 5; ++i) {
+		if (suits[HandEval::suit(hand[i])] == 4) {
+			mask |= 1 << i;
+		}
+	}
+	if (mask != 0) {
+		return mask;
+	}
+	for (int i = 0; i < 5; ++i) {
+		int r = HandEval::rank(hand[i]);
+		if (r == 0 or r >= 10) {
+			mask |= 1 << i;
+		}
+	}
+	return mask;
+}
+
+// royalChaser -> same as simple, but breaks up anything short of a straight flush to go for 3 or more to a royal
+int HoldStrategy::royalChaser(const int hand[5]) {
+	if (HandEval::category(hand) >= HandEval::STRAIGHT_FLUSH) {
+		return holdAll;
+	}
+	int royal = toRoyal(hand, 3);
+	return royal >= 0 ? royal : simple(hand);
+}
+
+// byName -> look up one of the built-ins. Returns nullptr for an unknown name.
+HoldStrategy::Rule HoldStrategy::byName(const std::string &name) {
+	if (name == "standpat") return standPat;
+	if (name == "discardall") return discardAll;
+	if (name == "simple") return simple;
+	if (name == "royalchaser") return royalChaser;
+	return nullptr;
+}
+
+#endif
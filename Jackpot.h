@@ -0,0 +1,354 @@
+/*
+ * This class is a progressive jackpot that any number of Game sessions can share -- threads in one process, or
+ * processes on the same machine through a file backed shared mapping (which also keeps the pot across restarts).
+ * Every bet feeds a fixed fraction into the pot and a royal flush wins the whole pot, after which it restarts from the
+ * seed amount that the house puts up.
+ *
+ * The accounting is kept in thousandths of a coin in a few counters that only ever go up:
+ *
+ *   pot = seeded + contributed - paid
+ *
+ * Contributions are a single atomic add on one of 64 cache line sized shards (each thread sticks to its own shard), so
+ * there's no hot global lock or counter on the betting path. A claim is the rare case: it takes the claim lock, sums
+ * the shards, and pays out the whole coins in the pot. Bets that land after the sum simply belong to the next pot, so
+ * every contribution is paid out exactly once. The claim writes what it's about to change into a journal first, so if
+ * its process dies halfway through, the next claimer finishes the claim.
+ *
+ * The claim lock is a mutex between the threads of a process plus, for a jackpot file, an flock on the file between
+ * processes. The kernel drops the flock when its process dies, so there's no owner pid to check (pids get reused, and
+ * mean nothing across pid namespaces).
+ *
+ * The journal also names the winner and how much they won. Crediting the winner is the Game's job and happens after the
+ * claim, so a process that dies in between leaves a pot that's paid but never credited. The winner calls credited()
+ * once the coins are in their bankroll, and books() shows whether the last win got that far, so such a pot can be
+ * settled by hand.
+ */
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef ATOMIC_H
+#define ATOMIC_H
+#include <atomic>
+#endif
+
+#ifndef THREAD_H
+#define THREAD_H
+#include <thread>
+#endif
+
+#ifndef MEMORY_H
+#define MEMORY_H
+#include <memory>
+#endif
+
+#ifndef MUTEX_H
+#define MUTEX_H
+#include <mutex>
+#endif
+
+#include <new>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifndef JACKPOT_H
+#define JACKPOT_H
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the jackpot's counters have to be lock free to live in shared memory");
+
+class Jackpot {
+	public:
+		static const int numShards = 64;
+		static const long long milli = 1000;  // counters are in thousandths of a coin
+		static const int winnerSize = 32;     // longest winner name kept, terminator included
+		struct Books {
+			long long seeded, contributed, paid, pot, hits;  // all in thousandths of a coin except hits
+			std::string lastWinner;                          // who won the last pot, and how many coins
+			long long lastWin;
+			bool lastCredited;                               // whether that win made it into their bankroll
+		};
+	private:
+		struct Shard {
+			std::atomic<unsigned long long> total;
+			char padding[64 - sizeof(std::atomic<unsigned long long>)];
+		};
+		struct Journal {
+			std::atomic<unsigned> active;
+			unsigned long long seededAfter, paidAfter, hitsAfter;
+			long long wonCoins;                    // the last claim's winner and payout, kept after it's applied
+			char winner[winnerSize];
+		};
+		struct State {
+			Shard shards[numShards];  // first, so they start on a page (and cache line) boundary
+			unsigned magic, version;
+			long long seedMilli;      // the pot restarts at this much after a win
+			long long rate;           // thousandths of a coin that go into the pot per coin bet
+			std::atomic<unsigned> ready;
+			std::atomic<unsigned long long> seeded, paid, hits;
+			std::atomic<unsigned long long> creditedHit;  // the last hit whose winner got the coins
+			Journal journal;
+		};
+		static const unsigned magicNumber = 0x54504B4A;  // "JKPT"
+		static const unsigned currentVersion = 2;
+		State *state{nullptr};
+		int fd{-1};              // the jackpot file, kept open for its flock
+		std::mutex claimMutex;   // the claim lock between this process' threads
+		Jackpot() {}
+		void init(long long seedCoins, long long ratePerMille);
+		static std::unique_ptr<Jackpot> create(const std::string &path, long long seedCoins, long long ratePerMille,
+			std::string &error);
+		void lockClaims();
+		void unlockClaims();
+		void finishJournal();
+		static int shardForThisThread();
+	public:
+		~Jackpot();
+		Jackpot(const Jackpot&) = delete;
+		Jackpot& operator=(const Jackpot&) = delete;
+		static std::unique_ptr<Jackpot> local(long long seedCoins, long long ratePerMille);
+		static std::unique_ptr<Jackpot> open(const std::string &path, long long seedCoins, long long ratePerMille,
+			std::string &error);
+		void contribute(int betCoins);
+		long long claim(const std::string &winner = std::string(), unsigned long long *hit = nullptr);
+		void credited(unsigned long long hit);
+		long long currentPot() const;
+		Books books() const;
+};
+
+// local -> a jackpot shared by the threads of this process only
+std::unique_ptr<Jackpot> Jackpot::local(long long seedCoins, long long ratePerMille) {
+	std::unique_ptr<Jackpot> jackpot(new Jackpot);
+	void *mem = mmap(nullptr, sizeof(State), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (mem == MAP_FAILED) {
+		return nullptr;
+	}
+	jackpot->state = static_cast<State*>(mem);
+	jackpot->init(seedCoins, ratePerMille);
+	return jackpot;
+}
+
+// open -> map the jackpot file, creating it if it isn't there yet. A new file is sized and initialized under a
+// temporary name and then linked into place, which fails if somebody else's got there first, so a jackpot file is
+// never seen half made and nobody has to wait on anyone. A file that's too short or was never initialized is an
+// error, not something to wait for. The seed and rate only count when the file is created.
+std::unique_ptr<Jackpot> Jackpot::open(const std::string &path, long long seedCoins, long long ratePerMille,
+		std::string &error) {
+	int fd = ::open(path.c_str(), O_RDWR);
+	if (fd < 0 and errno == ENOENT) {
+		std::unique_ptr<Jackpot> created = create(path, seedCoins, ratePerMille, error);
+		if (created or !error.empty()) {
+			return created;
+		}
+		fd = ::open(path.c_str(), O_RDWR);  // lost the race, open the winner's
+	}
+	if (fd < 0) {
+		error = "can't open " + path;
+		return nullptr;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 or st.st_size < (off_t)sizeof(State)) {
+		error = path + " is too short to be a jackpot file";
+		close(fd);
+		return nullptr;
+	}
+	void *mem = mmap(nullptr, sizeof(State), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (mem == MAP_FAILED) {
+		error = "can't map " + path;
+		close(fd);
+		return nullptr;
+	}
+	std::unique_ptr<Jackpot> jackpot(new Jackpot);
+	jackpot->fd = fd;
+	jackpot->state = static_cast<State*>(mem);
+	if (jackpot->state->ready.load(std::memory_order_acquire) != 1 or jackpot->state->magic != magicNumber
+			or jackpot->state->version != currentVersion) {
+		error = path + " isn't an initialized version " + std::to_string(currentVersion) + " jackpot file";
+		return nullptr;
+	}
+	jackpot->lockClaims();  // finishes a claim left behind by a process that died, if there is one
+	jackpot->finishJournal();
+	jackpot->unlockClaims();
+	return jackpot;
+}
+
+// create -> a fresh jackpot file at path, made under a temporary name first. Returns nullptr with no error if another
+// process linked its file into place first.
+std::unique_ptr<Jackpot> Jackpot::create(const std::string &path, long long seedCoins, long long ratePerMille,
+		std::string &error) {
+	const std::string temp = path + ".tmp" + std::to_string(getpid());
+	int fd = ::open(temp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0) {
+		error = "can't create " + temp;
+		return nullptr;
+	}
+	if (ftruncate(fd, sizeof(State)) != 0) {
+		error = "can't size " + temp;
+		close(fd);
+		unlink(temp.c_str());
+		return nullptr;
+	}
+	void *mem = mmap(nullptr, sizeof(State), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (mem == MAP_FAILED) {
+		error = "can't map " + temp;
+		close(fd);
+		unlink(temp.c_str());
+		return nullptr;
+	}
+	std::unique_ptr<Jackpot> jackpot(new Jackpot);
+	jackpot->fd = fd;  // the same file as path once it's linked, so its flock is the one everybody takes
+	jackpot->state = static_cast<State*>(mem);
+	jackpot->init(seedCoins, ratePerMille);
+	msync(mem, sizeof(State), MS_SYNC);
+	int linked = link(temp.c_str(), path.c_str());
+	int linkError = errno;
+	unlink(temp.c_str());
+	if (linked != 0) {
+		if (linkError != EEXIST) {
+			error = "can't create " + path;
+		}
+		return nullptr;
+	}
+	return jackpot;
+}
+
+Jackpot::~Jackpot() {
+	if (this->state != nullptr) {
+		if (this->fd >= 0) {
+			msync(this->state, sizeof(State), MS_SYNC);
+		}
+		munmap(this->state, sizeof(State));
+	}
+	if (this->fd >= 0) {
+		close(this->fd);
+	}
+}
+
+// init -> fresh pot made up of just the seed. The counters are placement new'd since the memory comes from mmap.
+void Jackpot::init(long long seedCoins, long long ratePerMille) {
+	State *s = this->state;
+	for (int i = 0; i < numShards; ++i) {
+		new (&s->shards[i].total) std::atomic<unsigned long long>(0);
+	}
+	s->magic = magicNumber;
+	s->version = currentVersion;
+	s->seedMilli = seedCoins * milli;
+	s->rate = ratePerMille;
+	new (&s->seeded) std::atomic<unsigned long long>(s->seedMilli);
+	new (&s->paid) std::atomic<unsigned long long>(0);
+	new (&s->hits) std::atomic<unsigned long long>(0);
+	new (&s->creditedHit) std::atomic<unsigned long long>(0);
+	new (&s->journal.active) std::atomic<unsigned>(0);
+	s->journal.wonCoins = 0;
+	s->journal.winner[0] = '\0';
+	new (&s->ready) std::atomic<unsigned>(0);
+	s->ready.store(1, std::memory_order_release);
+}
+
+// shardForThisThread -> spread threads (and processes) over the shards round robin, once per thread
+int Jackpot::shardForThisThread() {
+	static std::atomic<unsigned> nextThread(0);
+	static thread_local int shard = (getpid() * 7 + nextThread++) % numShards;
+	return shard;
+}
+
+// contribute -> the betting path: one relaxed atomic add, no lock
+void Jackpot::contribute(int betCoins) {
+	this->state->shards[shardForThisThread()].total.fetch_add(betCoins * this->state->rate, std::memory_order_relaxed);
+}
+
+// lockClaims -> the mutex first, since threads sharing this Jackpot share its fd and an flock doesn't tell them apart,
+// then the flock against other processes (or other Jackpots on the same file). A claim left behind by a process that
+// died is finished by whoever calls finishJournal() next.
+void Jackpot::lockClaims() {
+	this->claimMutex.lock();
+	while (this->fd >= 0 and flock(this->fd, LOCK_EX) != 0 and errno == EINTR) {
+	}
+}
+
+void Jackpot::unlockClaims() {
+	if (this->fd >= 0) {
+		flock(this->fd, LOCK_UN);
+	}
+	this->claimMutex.unlock();
+}
+
+// finishJournal -> apply a claim that was written to the journal but maybe not (fully) applied. Plain stores, so doing
+// it twice is harmless.
+void Jackpot::finishJournal() {
+	Journal &j = this->state->journal;
+	if (j.active.load(std::memory_order_acquire) == 0) {
+		return;
+	}
+	this->state->seeded.store(j.seededAfter);
+	this->state->paid.store(j.paidAfter);
+	this->state->hits.store(j.hitsAfter);
+	j.active.store(0, std::memory_order_release);
+}
+
+// claim -> pay out the whole coins in the pot to winner and reseed it. The thousandths that don't make a whole coin stay
+// in. hit gets the claim's number to hand to credited() once the winner has the coins.
+long long Jackpot::claim(const std::string &winner, unsigned long long *hit) {
+	lockClaims();
+	finishJournal();
+	unsigned long long contributed = 0;
+	for (int i = 0; i < numShards; ++i) {
+		contributed += this->state->shards[i].total.load(std::memory_order_acquire);
+	}
+	unsigned long long seeded = this->state->seeded.load(), paid = this->state->paid.load();
+	long long coins = (seeded + contributed - paid) / milli;
+	Journal &j = this->state->journal;
+	j.seededAfter = seeded + this->state->seedMilli;
+	j.paidAfter = paid + coins * milli;
+	j.hitsAfter = this->state->hits.load() + 1;
+	j.wonCoins = coins;
+	std::strncpy(j.winner, winner.c_str(), winnerSize - 1);
+	j.winner[winnerSize - 1] = '\0';
+	j.active.store(1, std::memory_order_release);
+	finishJournal();
+	if (this->fd >= 0) {
+		msync(this->state, sizeof(State), MS_SYNC);
+	}
+	if (hit != nullptr) {
+		*hit = j.hitsAfter;
+	}
+	unlockClaims();
+	return coins;
+}
+
+// credited -> the winner of claim number hit has the coins in their bankroll
+void Jackpot::credited(unsigned long long hit) {
+	unsigned long long last = this->state->creditedHit.load();
+	while (last < hit and !this->state->creditedHit.compare_exchange_weak(last, hit)) {
+	}
+}
+
+// currentPot -> whole coins a royal flush would win right now
+long long Jackpot::currentPot() const {
+	return books().pot / milli;
+}
+
+// books -> the counters and the last win. They're only guaranteed to add up while no claim is in flight.
+Jackpot::Books Jackpot::books() const {
+	Books b;
+	b.contributed = 0;
+	for (int i = 0; i < numShards; ++i) {
+		b.contributed += this->state->shards[i].total.load(std::memory_order_acquire);
+	}
+	b.seeded = this->state->seeded.load();
+	b.paid = this->state->paid.load();
+	b.hits = this->state->hits.load();
+	b.pot = b.seeded + b.contributed - b.paid;
+	const Journal &j = this->state->journal;
+	b.lastWinner = std::string(j.winner, strnlen(j.winner, winnerSize));
+	b.lastWin = j.wonCoins;
+	b.lastCredited = b.hits == 0 or this->state->creditedHit.load() >= (unsigned long long)b.hits;
+	return b;
+}
+
+#endif
@@ -29,6 +29,7 @@ class Player {
 		int bankroll{0}; 
 	public:
 		Player(std::string n, int savings): name(n), moneyForPoker(savings) {}; 
+		friend class SessionSnapshot;  // saves and restores the balances 
 		~Player();
 		std::string getName() const { return this->name; } 
 		int getBankroll() { return this->bankroll; }  
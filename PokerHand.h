@@ -51,6 +51,7 @@ class PokerHand {
 		std::vector<Card> hand; 
 		int payout_multiplier{0}; 
 	public: 
+		static const int royalFlushMult = 250;  // the Game swaps this for the jackpot in progressive mode 
 		PokerHand(const std::vector<Card> &vect);  // not allowing a default ctor -- need Card parameters 
 		int getPayoutMult() { return this->payout_multiplier;} 
 		// the below are evaluation functions for Poker hands 
@@ -84,16 +85,9 @@ PokerHand::PokerHand(const std::vector<Card> &vect) {
 bool PokerHand::evalJacksOrBetter() {
 	// we can directly check for the other types of winnings by calling in order of rank precedence. 
 	// If we win one of those hands, we'll exit out and the payout multiplier will accurately reflect that. 
-	bool checkRF = evalRoyalFlush(); 
-	bool checkSF = evalStraightFlush();
-	bool check4k = evalFourKind();
-	bool checkFullH = evalFullHouse(); 
-	bool checkF = evalFlush(); 
-	bool checkS = evalStraight(); 
-	bool check3k = evalThreeKind();
-	bool check2p = evalTwoPair(); 
-
-	if (check2p or check3k or checkS or checkF or checkFullH or check4k or checkRF or checkSF) {
+	// The short-circuit matters: a full house would otherwise also score as a 3 of a kind and overwrite the multiplier. 
+	if (evalRoyalFlush() or evalStraightFlush() or evalFourKind() or evalFullHouse() or evalFlush() 
+			or evalStraight() or evalThreeKind() or evalTwoPair()) {
 		return true; 
 	}
 
@@ -193,7 +187,7 @@ bool PokerHand::evalThreeKind() {
 // rank sequences using a vector of vectors. Then we iterate through each possibility and compare each one to our hand. 
 // Once a possibility rank-sequence fully matches with our hand, we can return true. 
 bool PokerHand::evalStraight() {
-	std::vector<std::string> seq = {"Ace", "2", "3", "4", "5", "6", "7", "8", "9", "10", "jack", "queen", "king"}; 
+	std::vector<std::string> seq = {"ace", "2", "3", "4", "5", "6", "7", "8", "9", "10", "jack", "queen", "king"}; 
 	std::vector<std::vector<std::string>> all_poss;  // vector of vectors 
 	std::vector<std::string> poss;
 	for (int i = 0; i < seq.size() - 4; ++i) { // once you reach the 9th card, can't add 5 cards anymore 
@@ -203,19 +197,18 @@ bool PokerHand::evalStraight() {
 		all_poss.push_back(poss); 
 		poss.clear();
 	}
-	int match_count; 
-	std::string val; 
+	all_poss.push_back({"10", "jack", "queen", "king", "ace"}); // ace plays high too 
+	int match_count = 0; 
 	for (int i = 0; i < all_poss.size(); ++i) {  // iterate through all the combinations 
 		poss = all_poss[i]; 
-		for (int j = 0; j < this->hand.size(); ++j) {  // iterate through entire hand 
-			val = this->hand[j].getCardValue(); 
-			for (int z = 0; z < poss.size(); ++z) {  // iterate through all of current possibility to match 
-				if (val == poss[z]) {
+		for (int z = 0; z < poss.size(); ++z) {  // every rank of the possibility has to show up in the hand 
+			for (int j = 0; j < this->hand.size(); ++j) {  // (counting ranks, not cards, so a pair can't fill a gap) 
+				if (this->hand[j].getCardValue() == poss[z]) {
 					++match_count; 
+					break; 
 				}
 			}
 		}
-		match_count = 0;  // reset match_count for the next rank-seq possibility 
 		if (match_count == 5) { 
 			this->payout_multiplier = 4;		// if match found, we can return true  
 			std::cout << "\nFound a Straight" << std::endl; 
@@ -307,7 +300,7 @@ bool PokerHand::evalFourKind() {
 // Gather all the possible combinations of getting a sequential 5-card sequence. Then for each of these 
 // combinations, we need to check if our current 5 card set has any matches with any of the possibility sets. 
 bool PokerHand::evalStraightFlush() { 
-	std::vector<std::string> seq = {"Ace", "2", "3", "4", "5", "6", "7", "8", "9", "10", "jack", "queen", "king"}; 
+	std::vector<std::string> seq = {"ace", "2", "3", "4", "5", "6", "7", "8", "9", "10", "jack", "queen", "king"}; 
 	std::vector<std::vector<std::string>> all_poss;  // vector of vectors 
 	std::vector<std::string> poss;
 	for (int i = 0; i < seq.size() - 4; ++i) { // once you reach the 9th card, can't add 5 cards anymore 
@@ -326,7 +319,7 @@ bool PokerHand::evalStraightFlush() {
 			return false; 
 		}
 	}
-	int match_count; 
+	int match_count = 0; 
 	std::string val; 
 	for (int i = 0; i < all_poss.size(); ++i) {  // iterate through all the combinations 
 		poss = all_poss[i]; 
@@ -377,7 +370,7 @@ bool PokerHand::evalRoyalFlush() {
 		}
 	}
 	if (isTen and isJack and isKing and isQueen and isAce) {
-		this->payout_multiplier = 250;  // winnings 
+		this->payout_multiplier = royalFlushMult;  // winnings 
 		std::cout << "\nFound a Royal Flush!" << std::endl; 
 		return true; 
 	}
@@ -0,0 +1,343 @@
+/*
+ * This class estimates how often a rare hand (a royal flush or a straight flush) comes out of a full round -- deal,
+ * hold with some HoldStrategy, draw -- and how much it adds to the return. Naive Monte Carlo needs hundreds of millions
+ * of rounds for that, so on top of the naive mode there are two variance reduced ones:
+ *
+ *   CONDITIONAL -> conditional Monte Carlo: for each sampled deal the draw is integrated out exactly given the cards
+ *                  the strategy holds. We count the target hands that contain the held cards and none of the discards,
+ *                  divided by the number of possible draws. No draw is ever simulated.
+ *   IMPORTANCE  -> same exact draw, but half the deals come from the "near" set (3 or more cards of some target hand),
+ *                  which is where almost all of the probability is, and every sample is weighted by p(deal) / q(deal).
+ *
+ * Every mode also uses a control variate whose mean we know exactly: the (weighted) indicator that the deal is in the
+ * near set. Its exact probability comes from enumerating all 2,598,960 deals once in the ctor.
+ *
+ * Deals that already are a target hand are worked out exactly instead of sampled. There are only 4 dealt royals (36
+ * straight flushes), but each is worth a whole target hand, so a run's error would otherwise mostly come down to how
+ * many of them it happened to see (a dealt royal comes up once in 650,000 deals). Sampled deals that are target hands
+ * count 0 and the exact sum over all of them is added to every estimate.
+ */
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef RANDOM_H
+#define RANDOM_H
+#include <random>
+#endif
+
+#ifndef CMATH_H
+#define CMATH_H
+#include <cmath>
+#endif
+
+#ifndef ALGORITHM_H
+#define ALGORITHM_H
+#include <algorithm>
+#endif
+
+#include "HandEval.h"
+#include "HoldStrategy.h"
+
+#ifndef RAREEVENTESTIMATOR_H
+#define RAREEVENTESTIMATOR_H
+
+class RareEventEstimator {
+	public:
+		enum Mode { NAIVE, CONDITIONAL, IMPORTANCE };
+		struct Estimate {
+			double frequency{0.0};
+			double stdError{0.0};
+			long long samples{0};
+			long long pilotSamples{0};  // the pilot run that picked `samples`. Its hands aren't in the estimate.
+			long long neededSamples{0}; // what the precision asked for takes, going by this run (more than samples if short)
+			double halfWidth() const { return 1.96 * this->stdError; }  // 95% confidence interval
+		};
+		// running sums of the sample value y and the control variate x. Tallies from different runs can be added up.
+		struct Tally {
+			long long n{0};
+			double sumY{0.0}, sumYY{0.0}, sumX{0.0}, sumXX{0.0}, sumXY{0.0};
+			void add(double x, double y);
+			void merge(const Tally &other);
+			Estimate estimate(double meanX) const;
+		};
+	private:
+		HoldStrategy::Rule strategy;
+		int target;
+		Mode mode;
+		std::mt19937_64 rng;
+		int order[52];
+		std::vector<unsigned long long> targets;  // every 5 card hand in the target category, as bitsets of card ids
+		double nearProb{0.0};                     // exact P(deal has 3+ cards of some target hand)
+		double dealtPart{0.0};                    // exact P(deal is a target hand and the round ends in one)
+		const double mixture{0.5};                // importance mode: half the deals come from the near set
+		Tally tally;
+		static double choose(int n, int k);
+		static unsigned long long bits(const int hand[5]);
+		int drawBelow(int n);
+		int nearTargets(unsigned long long deal) const;
+		double exactProb(const int hand[5], int hold) const;
+		void dealUniform(int hand[5]);
+		void dealNear(int hand[5]);
+		void sample();
+	public:
+		RareEventEstimator(HoldStrategy::Rule s, int targetCategory, Mode m, unsigned long long seed);
+		Estimate run(double relHalfWidth, long long maxSamples);
+		Estimate current() const;
+		double nearProbability() const { return this->nearProb; }
+};
+
+// ctor -> list the target hands and count the near set exactly by going through every deal
+RareEventEstimator::RareEventEstimator(HoldStrategy::Rule s, int targetCategory, Mode m, unsigned long long seed):
+		strategy(s), target(targetCategory), mode(m), rng(seed) {
+	for (int i = 0; i < 52; ++i) {
+		this->order[i] = i;
+	}
+	int h[5];
+	for (h[0] = 0; h[0] < 52; ++h[0])
+	for (h[1] = h[0] + 1; h[1] < 52; ++h[1])
+	for (h[2] = h[1] + 1; h[2] < 52; ++h[2])
+	for (h[3] = h[2] + 1; h[3] < 52; ++h[3])
+	for (h[4] = h[3] + 1; h[4] < 52; ++h[4]) {
+		if (HandEval::category(h) == this->target) {
+			this->targets.push_back(bits(h));
+		}
+	}
+	long long near = 0, total = 0;
+	for (h[0] = 0; h[0] < 52; ++h[0])
+	for (h[1] = h[0] + 1; h[1] < 52; ++h[1])
+	for (h[2] = h[1] + 1; h[2] < 52; ++h[2])
+	for (h[3] = h[2] + 1; h[3] < 52; ++h[3])
+	for (h[4] = h[3] + 1; h[4] < 52; ++h[4]) {
+		++total;
+		if (nearTargets(bits(h)) > 0) {
+			++near;
+		}
+	}
+	this->nearProb = double(near) / total;
+	for (std::size_t t = 0; t < this->targets.size(); ++t) {
+		int hand[5], count = 0;
+		for (int id = 0; id < 52; ++id) {
+			if (this->targets[t] >> id & 1) {
+				hand[count++] = id;
+			}
+		}
+		this->dealtPart += exactProb(hand, this->strategy(hand)) / total;
+	}
+}
+
+// current -> the sampled part of the estimate plus the exact part from dealt target hands
+RareEventEstimator::Estimate RareEventEstimator::current() const {
+	Estimate e = this->tally.estimate(this->nearProb);
+	e.frequency += this->dealtPart;
+	return e;
+}
+
+double RareEventEstimator::choose(int n, int k) {
+	double c = 1.0;
+	for (int i = 0; i < k; ++i) {
+		c = c * (n - i) / (i + 1);
+	}
+	return c;
+}
+
+unsigned long long RareEventEstimator::bits(const int hand[5]) {
+	unsigned long long b = 0;
+	for (int i = 0; i < 5; ++i) {
+		b |= 1ULL << hand[i];
+	}
+	return b;
+}
+
+// drawBelow -> unbiased number in [0, n), same rejection trick as DealStream
+int RareEventEstimator::drawBelow(int n) {
+	const unsigned long long range = std::mt19937_64::max();
+	const unsigned long long limit = range - (range % n + 1) % n;
+	unsigned long long r;
+	do {
+		r = this->rng();
+	} while (r > limit);
+	return r % n;
+}
+
+// nearTargets -> how many target hands share 3 or more cards with the deal
+int RareEventEstimator::nearTargets(unsigned long long deal) const {
+	int count = 0;
+	for (std::size_t t = 0; t < this->targets.size(); ++t) {
+		if (__builtin_popcountll(deal & this->targets[t]) >= 3) {
+			++count;
+		}
+	}
+	return count;
+}
+
+// exactProb -> P(target | deal, hold). The draw is 5 - held cards out of the 47 we didn't see, so the target hands we
+// can still make are the ones that contain every held card and none of the discards.
+double RareEventEstimator::exactProb(const int hand[5], int hold) const {
+	unsigned long long held = 0, discards = 0;
+	int drawn = 0;
+	for (int i = 0; i < 5; ++i) {
+		if (hold >> i & 1) {
+			held |= 1ULL << hand[i];
+		}
+		else {
+			discards |= 1ULL << hand[i];
+			++drawn;
+		}
+	}
+	int count = 0;
+	for (std::size_t t = 0; t < this->targets.size(); ++t) {
+		if ((this->targets[t] & held) == held and (this->targets[t] & discards) == 0) {
+			++count;
+		}
+	}
+	return count / choose(47, drawn);
+}
+
+// dealUniform -> first 5 steps of a Fisher-Yates shuffle. The other 47 cards are left in order[5..51] for the draw.
+void RareEventEstimator::dealUniform(int hand[5]) {
+	for (int i = 0; i < 5; ++i) {
+		std::swap(this->order[i], this->order[i + drawBelow(52 - i)]);
+		hand[i] = this->order[i];
+	}
+}
+
+// dealNear -> uniform over the near set. Pick a target hand, how many of its cards to use (weighted by how many deals
+// have exactly that overlap), which ones, and fill up from the other 47 cards. A deal near c target hands can be made c
+// ways, so we keep it with probability 1/c.
+void RareEventEstimator::dealNear(int hand[5]) {
+	double weights[3];
+	for (int k = 3; k <= 5; ++k) {
+		weights[k - 3] = choose(5, k) * choose(47, 5 - k);
+	}
+	std::discrete_distribution<int> overlap(weights, weights + 3);
+	while (true) {
+		unsigned long long t = this->targets[drawBelow(this->targets.size())];
+		int k = 3 + overlap(this->rng);
+		int in[5], out[47], nin = 0, nout = 0;
+		for (int id = 0; id < 52; ++id) {
+			if (t >> id & 1) in[nin++] = id;
+			else out[nout++] = id;
+		}
+		for (int i = 0; i < k; ++i) {
+			std::swap(in[i], in[i + drawBelow(5 - i)]);
+			hand[i] = in[i];
+		}
+		for (int i = 0; i < 5 - k; ++i) {
+			std::swap(out[i], out[i + drawBelow(47 - i)]);
+			hand[k + i] = out[i];
+		}
+		int c = nearTargets(bits(hand));
+		if (drawBelow(c) == 0) {
+			return;
+		}
+	}
+}
+
+// sample -> one round. y is this round's (weighted) estimate of P(target) and x is the control variate.
+void RareEventEstimator::sample() {
+	int hand[5];
+	double weight = 1.0;
+	if (this->mode == IMPORTANCE and drawBelow(2) == 0) {
+		dealNear(hand);
+	}
+	else {
+		dealUniform(hand);
+	}
+	bool near = nearTargets(bits(hand)) > 0;
+	if (this->mode == IMPORTANCE) {
+		weight = 1.0 / ((1.0 - this->mixture) + (near ? this->mixture / this->nearProb : 0.0));
+	}
+	int hold = this->strategy(hand);
+	double y;
+	if (HandEval::category(hand) == this->target) {  // counted exactly, see dealtPart
+		this->tally.add(near ? weight : 0.0, 0.0);
+		return;
+	}
+	if (this->mode == NAIVE) {
+		int final[5], next = 5;
+		for (int i = 0; i < 5; ++i) {
+			if (hold >> i & 1) {
+				final[i] = hand[i];
+			}
+			else {  // deal the replacement off the rest of the deck, like Game::dealHand
+				std::swap(this->order[next], this->order[next + drawBelow(52 - next)]);
+				final[i] = this->order[next++];
+			}
+		}
+		y = HandEval::category(final) == this->target ? 1.0 : 0.0;
+	}
+	else {
+		y = weight * exactProb(hand, hold);
+	}
+	this->tally.add(near ? weight : 0.0, y);
+}
+
+// run -> two stages. A pilot run sizes the main run for an interval within relHalfWidth of the estimate, then the main
+// run starts over with fresh samples and reports only its own. Stopping on the running interval instead would end runs
+// on the stretches that happen to lack the rare heavy samples (a royal dealt outright, in importance mode), and those
+// estimates come out low. The pilot is 100k hands, or a tenth of maxSamples when that's less, and the main run gets 10%
+// more hands than the pilot says so that it usually makes the precision. If it still doesn't, neededSamples says so.
+RareEventEstimator::Estimate RareEventEstimator::run(double relHalfWidth, long long maxSamples) {
+	const long long pilot = std::max(1LL, std::min(maxSamples / 10, 100000LL));
+	for (long long i = 0; i < pilot; ++i) {
+		sample();
+	}
+	Estimate first = current();
+	long long n = maxSamples;
+	if (first.frequency > 0 and first.stdError > 0) {  // std. error goes with 1/sqrt(n)
+		double needed = 1.1 * pilot * std::pow(first.halfWidth() / (relHalfWidth * first.frequency), 2);
+		n = std::max(2LL, (long long)std::min(std::ceil(needed), double(maxSamples)));
+	}
+	this->tally = Tally();
+	for (long long i = 0; i < n; ++i) {
+		sample();
+	}
+	Estimate e = current();
+	e.pilotSamples = pilot;
+	e.neededSamples = n;
+	if (e.frequency > 0 and e.halfWidth() > relHalfWidth * e.frequency) {  // the pilot undersized it, or maxSamples did
+		e.neededSamples = (long long)std::ceil(n * std::pow(e.halfWidth() / (relHalfWidth * e.frequency), 2));
+	}
+	return e;
+}
+
+void RareEventEstimator::Tally::add(double x, double y) {
+	++this->n;
+	this->sumY += y;
+	this->sumYY += y * y;
+	this->sumX += x;
+	this->sumXX += x * x;
+	this->sumXY += x * y;
+}
+
+void RareEventEstimator::Tally::merge(const Tally &other) {
+	this->n += other.n;
+	this->sumY += other.sumY;
+	this->sumYY += other.sumYY;
+	this->sumX += other.sumX;
+	this->sumXX += other.sumXX;
+	this->sumXY += other.sumXY;
+}
+
+// estimate -> control variate estimate y - c (x - E[x]) with the regression coefficient c = cov(x, y) / var(x). The
+// variance left over is var(y) minus the part x explains.
+RareEventEstimator::Estimate RareEventEstimator::Tally::estimate(double meanX) const {
+	Estimate e;
+	e.samples = this->n;
+	if (this->n < 2) {
+		return e;
+	}
+	double my = this->sumY / this->n, mx = this->sumX / this->n;
+	double varY = this->sumYY / this->n - my * my;
+	double varX = this->sumXX / this->n - mx * mx;
+	double cov = this->sumXY / this->n - mx * my;
+	double c = varX > 0 ? cov / varX : 0.0;
+	double residual = varX > 0 ? varY - cov * cov / varX : varY;
+	e.frequency = std::max(0.0, my - c * (mx - meanX));
+	e.stdError = std::sqrt(std::max(0.0, residual) / (this->n - 1));
+	return e;
+}
+
+#endif
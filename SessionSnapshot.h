@@ -0,0 +1,234 @@
+/*
+ * This class saves live Game sessions to a compact binary snapshot and restores them, so a server can be drained and
+ * restarted without dropping anybody -- even in the middle of a round, between the deal and the draw. A session is the
+ * Player's balances, the Game's deposit, bet and phase, the current hand and the Deck (the cards left in order and the
+ * cards dealt so far). Cards go in as one byte ids (0-51, suit-major like the Deck ctor), so a session takes about 90
+ * bytes and saving or restoring one takes a few microseconds.
+ *
+ * Snapshotting reads the Games, Players and Decks directly and takes no locks, so the caller has to quiesce every
+ * session first: nothing may bet, deal, draw or evaluate on any of them until write() or save() returns. A server
+ * does that by draining, i.e. pausing each session's thread between actions.
+ *
+ * Layout: magic, version, session count, the sessions, then a checksum of all of it (see BinaryIO.h). A snapshot with a
+ * bad checksum or version is turned down whole. Past that, each session is checked on its own: its Deck has to hold
+ * each of the 52 cards exactly once and its hand has to fit its phase. A session that doesn't is skipped and reported,
+ * and the rest are still restored. The DealStream and Jackpot a Game was using are process resources, not session
+ * state: hook them back up after restoring.
+ */
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef MEMORY_H
+#define MEMORY_H
+#include <memory>
+#endif
+
+#include "Game.h"
+#include "BinaryIO.h"
+
+#ifndef SESSIONSNAPSHOT_H
+#define SESSIONSNAPSHOT_H
+
+class SessionSnapshot {
+	public:
+		static const unsigned magicNumber = 0x53534B50;  // "PKSS"
+		static const unsigned currentVersion = 1;
+		struct Session {  // a restored session owns its objects
+			std::unique_ptr<Player> player;
+			std::unique_ptr<Deck> deck;
+			std::unique_ptr<Game> game;
+		};
+	private:
+		template <typename Cards>
+		static void putCards(BinaryWriter &w, const Cards &cards);
+		template <typename Cards>
+		static bool getCards(BinaryReader &r, Cards &cards, std::size_t maxCount, bool *seen);
+		static bool restoreOne(BinaryReader &r, Session &s, std::string &error);
+	public:
+		static void write(const std::vector<Game*> &games, BinaryWriter &w);
+		static bool read(const std::string &buf, std::vector<Session> &sessions, std::vector<std::string> &skipped,
+			std::string &error);
+		static bool save(const std::string &path, const std::vector<Game*> &games);
+		static bool load(const std::string &path, std::vector<Session> &sessions, std::vector<std::string> &skipped,
+			std::string &error);
+};
+
+// putCards -> count, then one byte per card
+template <typename Cards>
+void SessionSnapshot::putCards(BinaryWriter &w, const Cards &cards) {
+	unsigned char ids[52];
+	std::size_t n = 0;
+	for (typename Cards::const_iterator it = cards.begin(); it != cards.end() and n < 52; ++it) {
+		ids[n++] = Deck::cardId(*it);
+	}
+	w.put<unsigned char>(n);
+	w.putBytes(ids, n);
+}
+
+// getCards -> read back what putCards wrote. With `seen`, each card also gets ticked off and a card that's already
+// ticked is an error (the Deck's remaining and dealt cards share one `seen`). All the bytes get read even when the cards
+// are bad, so the reader stays lined up with the next session.
+template <typename Cards>
+bool SessionSnapshot::getCards(BinaryReader &r, Cards &cards, std::size_t maxCount, bool *seen) {
+	unsigned char ids[256];
+	unsigned char n = r.get<unsigned char>();
+	if (!r.ok() or !r.getBytes(ids, n) or n > maxCount) {
+		return false;
+	}
+	cards.clear();
+	for (int i = 0; i < n; ++i) {
+		if (ids[i] >= 52 or (seen != nullptr and seen[ids[i]])) {
+			return false;
+		}
+		if (seen != nullptr) {
+			seen[ids[i]] = true;
+		}
+		cards.push_back(Deck::card(ids[i]));
+	}
+	return true;
+}
+
+// write -> snapshot every session into the writer, checksum included. The sessions have to be quiesced (see the top).
+void SessionSnapshot::write(const std::vector<Game*> &games, BinaryWriter &w) {
+	w.put<unsigned>(magicNumber);
+	w.put<unsigned>(currentVersion);
+	w.put<unsigned>(games.size());
+	for (std::size_t i = 0; i < games.size(); ++i) {
+		const Game &g = *games[i];
+		w.putString(g.p1->name);
+		w.put<int>(g.p1->moneyForPoker);
+		w.put<int>(g.p1->bankroll);
+		w.put<int>(g.deposit);
+		w.put<int>(g.bet);
+		w.put<unsigned char>(g.play);
+		w.put<unsigned char>(g.phase);
+		putCards(w, g.currHand);
+		putCards(w, g.deck->deck);
+		putCards(w, g.deck->dealtCards);
+	}
+	w.putChecksum();
+}
+
+// restoreOne -> rebuild one session. The Deck's remaining and dealt cards have to make up the 52 cards between them,
+// and the hand has to be 5 different dealt cards once the round's dealt (and empty before that). The whole session is
+// read before any of that is checked, so after a bad session the reader is still at the next one unless it's !ok().
+bool SessionSnapshot::restoreOne(BinaryReader &r, Session &s, std::string &error) {
+	std::string name = r.getString();
+	int money = r.get<int>(), bankroll = r.get<int>(), deposit = r.get<int>(), bet = r.get<int>();
+	unsigned char play = r.get<unsigned char>(), phase = r.get<unsigned char>();
+	if (!r.ok()) {
+		error = "bad session header";
+		return false;
+	}
+	s.player.reset(new Player(name, money));
+	s.player->bankroll = bankroll;
+	s.deck.reset(new Deck);
+	s.game.reset(new Game(s.player.get(), s.deck.get()));
+	Game &g = *s.game;
+	g.deposit = deposit;
+	g.bet = bet;
+	g.play = play != 0;
+	g.phase = phase;
+	Deck &d = *s.deck;
+	bool held[52] = {false}, seen[52] = {false};
+	bool cardsOk = getCards(r, g.currHand, g.handSize, held);
+	cardsOk = getCards(r, d.deck, 52, seen) and cardsOk;
+	cardsOk = getCards(r, d.dealtCards, 52, seen) and cardsOk;
+	if (!cardsOk) {
+		error = "bad cards in " + name + "'s session";
+		return false;
+	}
+	if (phase > Game::DRAWN) {
+		error = name + "'s session has no such phase";
+		return false;
+	}
+	if (d.deck.size() + d.dealtCards.size() != 52) {
+		error = name + "'s deck is missing cards";
+		return false;
+	}
+	if (g.currHand.size() != (phase >= Game::DEALT ? std::size_t(g.handSize) : 0)) {
+		error = name + "'s hand doesn't match the round's phase";
+		return false;
+	}
+	for (std::size_t i = 0; i < d.dealtCards.size(); ++i) {  // every held card has to be one the deck dealt
+		held[Deck::cardId(d.dealtCards[i])] = false;
+	}
+	for (int id = 0; id < 52; ++id) {
+		if (held[id]) {
+			error = name + "'s hand has a card the deck never dealt";
+			return false;
+		}
+	}
+	d.dealt = !d.dealtCards.empty();
+	return true;
+}
+
+// read -> restore the sessions in a snapshot. The checksum is checked before anything gets built, and a snapshot that
+// fails it (or can't be read to the end) returns nothing. A session that doesn't check out on its own is left out, with
+// why in `skipped`, so the sessions that come back are numbered without it.
+bool SessionSnapshot::read(const std::string &buf, std::vector<Session> &sessions, std::vector<std::string> &skipped,
+		std::string &error) {
+	const std::size_t checksumSize = sizeof(unsigned long long);
+	BinaryReader body(buf.data(), buf.size() < checksumSize ? 0 : buf.size() - checksumSize);
+	unsigned magic = body.get<unsigned>(), version = body.get<unsigned>(), count = body.get<unsigned>();
+	if (!body.ok() or magic != magicNumber) {
+		error = "not a session snapshot";
+		return false;
+	}
+	if (version != currentVersion) {
+		error = "session snapshot version " + std::to_string(version) + " isn't supported";
+		return false;
+	}
+	unsigned long long stored;
+	std::memcpy(&stored, buf.data() + buf.size() - checksumSize, checksumSize);
+	if (stored != checksum(buf.data(), buf.size() - checksumSize)) {
+		error = "session snapshot is corrupted";
+		return false;
+	}
+	std::vector<Session> restored;
+	std::vector<std::string> bad;
+	for (unsigned i = 0; i < count and body.ok(); ++i) {
+		Session s;
+		std::string why;
+		if (restoreOne(body, s, why)) {
+			restored.push_back(std::move(s));
+		}
+		else if (body.ok()) {
+			bad.push_back("session " + std::to_string(i) + ": " + why);
+		}
+	}
+	if (!body.ok() or body.offset() != buf.size() - checksumSize) {
+		error = "session snapshot is corrupted";
+		return false;
+	}
+	sessions = std::move(restored);
+	skipped = std::move(bad);
+	return true;
+}
+
+// save -> snapshot to a file, replacing the old snapshot only once the new one is completely written. The sessions
+// have to be quiesced, as for write().
+bool SessionSnapshot::save(const std::string &path, const std::vector<Game*> &games) {
+	BinaryWriter w;
+	write(games, w);
+	return w.saveAtomically(path);
+}
+
+bool SessionSnapshot::load(const std::string &path, std::vector<Session> &sessions, std::vector<std::string> &skipped,
+		std::string &error) {
+	std::string buf;
+	if (!readFile(path, buf)) {
+		error = "can't read " + path;
+		return false;
+	}
+	return read(buf, sessions, skipped, error);
+}
+
+#endif
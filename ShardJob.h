@@ -0,0 +1,401 @@
+/*
+ * This class splits a long full-paytable analysis into shards that can run as independent processes, on this machine or
+ * any other, with no coordinator. A shard is described by a small text spec file:
+ *
+ *   kind exhaustive | sampled     exhaustive walks deal indexes (colex order, see DrawAnalyzer); sampled makes deal i
+ *                                 from its own seeded random stream, so it doesn't matter which shard draws it
+ *   paytable p0 ... p9            payout per category, Nothing up to Royal Flush (the game's by default)
+ *   strategy NAME                 optional HoldStrategy built-in to score next to optimal play
+ *   seed S                        sampled only
+ *   first F / last L              the shard's [F, L) range of deal or sample indexes
+ *   plan F L                      the [F, L) range of the whole plan, which the merged shards have to cover
+ *
+ * Every deal's draw is solved exactly, and all the totals are whole numbers in units of 1 / DrawAnalyzer::scale, so
+ * adding up shards gives exactly the same answer as one big run. While running, the shard saves its totals and how far
+ * it got to a binary checkpoint (with a checksum) every so often. If the process is killed, running it again on the same
+ * checkpoint picks up from there. Finished checkpoints from all shards of a plan merge into one result.
+ */
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef FSTREAM_H
+#define FSTREAM_H
+#include <fstream>
+#endif
+
+#ifndef SSTREAM_H
+#define SSTREAM_H
+#include <sstream>
+#endif
+
+#ifndef CHRONO_H
+#define CHRONO_H
+#include <chrono>
+#endif
+
+#include "BinaryIO.h"
+#include "DrawAnalyzer.h"
+#include "HoldStrategy.h"
+#include "WorkStealingPool.h"
+
+#ifndef SHARDJOB_H
+#define SHARDJOB_H
+
+class ShardJob {
+	public:
+		enum Kind { EXHAUSTIVE, SAMPLED };
+		struct Spec {
+			int kind{EXHAUSTIVE};
+			int paytable[HandEval::NUM_CATEGORIES];
+			std::string strategy;
+			unsigned long long seed{0};
+			long long first{0}, last{DrawAnalyzer::numDeals};
+			long long planFirst{0}, planLast{DrawAnalyzer::numDeals};
+			Spec();
+			bool sameJob(const Spec &other) const;  // everything but the shard's own range
+		};
+		struct Totals {
+			long long optimal{0}, strategy{0};                  // payout * scale, summed over deals
+			long long optimalCategories[HandEval::NUM_CATEGORIES] = {0};
+			long long strategyCategories[HandEval::NUM_CATEGORIES] = {0};
+			void add(const Totals &other);
+		};
+	private:
+		static const unsigned magic = 0x48534B50;  // "PKSH"
+		static const unsigned version = 2;
+		Spec spec;
+		long long next;  // first index not done yet
+		Totals totals;
+		static unsigned long long mix(unsigned long long x);
+	public:
+		ShardJob(): next(0) {}
+		ShardJob(const Spec &s): spec(s), next(s.first) {}
+		const Spec& getSpec() const { return this->spec; }
+		const Totals& getTotals() const { return this->totals; }
+		long long getNext() const { return this->next; }
+		bool done() const { return this->next >= this->spec.last; }
+		static void dealFor(const Spec &s, long long index, int hand[5]);
+		static bool loadSpec(const std::string &path, Spec &s, std::string &error);
+		static bool saveSpec(const std::string &path, const Spec &s);
+		static std::vector<Spec> plan(const Spec &whole, int shards);
+		bool saveCheckpoint(const std::string &path) const;
+		static bool loadCheckpoint(const std::string &path, ShardJob &job, std::string &error);
+		bool run(WorkStealingPool &pool, const std::string &checkpoint, double everySeconds, std::string &error,
+			const std::function<void(long long, long long)> &progress = nullptr);
+		static bool merge(const std::vector<ShardJob> &parts, ShardJob &merged, std::string &error);
+};
+
+ShardJob::Spec::Spec() {
+	for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+		this->paytable[c] = HandEval::payout(c);
+	}
+}
+
+bool ShardJob::Spec::sameJob(const Spec &other) const {
+	for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+		if (this->paytable[c] != other.paytable[c]) {
+			return false;
+		}
+	}
+	return this->kind == other.kind and this->strategy == other.strategy and this->seed == other.seed and
+		this->planFirst == other.planFirst and this->planLast == other.planLast;
+}
+
+void ShardJob::Totals::add(const Totals &other) {
+	this->optimal += other.optimal;
+	this->strategy += other.strategy;
+	for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+		this->optimalCategories[c] += other.optimalCategories[c];
+		this->strategyCategories[c] += other.strategyCategories[c];
+	}
+}
+
+// mix -> splitmix64 finalizer, our counter based random stream
+unsigned long long ShardJob::mix(unsigned long long x) {
+	x += 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+// dealFor -> the deal for an index. Sampled deals come from a random stream keyed on (seed, index) alone, with the same
+// unbiased partial Fisher-Yates the DealStream uses.
+void ShardJob::dealFor(const Spec &s, long long index, int hand[5]) {
+	if (s.kind == EXHAUSTIVE) {
+		DrawAnalyzer::unrankDeal(index, hand);
+		return;
+	}
+	int order[52];
+	for (int i = 0; i < 52; ++i) {
+		order[i] = i;
+	}
+	unsigned long long state = mix(s.seed) ^ mix(index);
+	for (int i = 0; i < 5; ++i) {
+		const unsigned long long n = 52 - i, limit = ~0ULL - (~0ULL % n + 1) % n;
+		unsigned long long r;
+		do {
+			state += 0x9E3779B97F4A7C15ULL;
+			r = mix(state);
+		} while (r > limit);
+		std::swap(order[i], order[i + r % n]);
+		hand[i] = order[i];
+	}
+}
+
+bool ShardJob::loadSpec(const std::string &path, Spec &s, std::string &error) {
+	std::ifstream in(path);
+	if (!in) {
+		error = "can't open " + path;
+		return false;
+	}
+	s = Spec();
+	bool planned = false;
+	std::string line;
+	while (std::getline(in, line)) {
+		std::istringstream fields(line);
+		std::string key, kind;
+		if (!(fields >> key)) {
+			continue;
+		}
+		if (key == "kind") {
+			fields >> kind;
+			if (kind != "exhaustive" and kind != "sampled") {
+				error = "unknown kind " + kind;
+				return false;
+			}
+			s.kind = kind == "exhaustive" ? EXHAUSTIVE : SAMPLED;
+		}
+		else if (key == "paytable") {
+			for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+				fields >> s.paytable[c];
+			}
+		}
+		else if (key == "strategy") fields >> s.strategy;
+		else if (key == "seed") fields >> s.seed;
+		else if (key == "first") fields >> s.first;
+		else if (key == "last") fields >> s.last;
+		else if (key == "plan") {
+			fields >> s.planFirst >> s.planLast;
+			planned = true;
+		}
+		else {
+			error = "unknown key " + key;
+			return false;
+		}
+		if (fields.fail()) {
+			error = "bad value for " + key;
+			return false;
+		}
+	}
+	if (!s.strategy.empty() and HoldStrategy::byName(s.strategy) == nullptr) {
+		error = "unknown strategy " + s.strategy;
+		return false;
+	}
+	if (!planned) {
+		error = "no plan range";
+		return false;
+	}
+	if (s.planFirst < 0 or s.first < s.planFirst or s.first > s.last or s.last > s.planLast or
+			(s.kind == EXHAUSTIVE and s.planLast > DrawAnalyzer::numDeals)) {
+		error = "bad range";
+		return false;
+	}
+	return true;
+}
+
+bool ShardJob::saveSpec(const std::string &path, const Spec &s) {
+	std::ofstream out(path);
+	out << "kind " << (s.kind == EXHAUSTIVE ? "exhaustive" : "sampled") << "\npaytable";
+	for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+		out << " " << s.paytable[c];
+	}
+	out << "\n";
+	if (!s.strategy.empty()) {
+		out << "strategy " << s.strategy << "\n";
+	}
+	out << "seed " << s.seed << "\nfirst " << s.first << "\nlast " << s.last << "\nplan " << s.planFirst << " "
+		<< s.planLast << "\n";
+	return bool(out);
+}
+
+// plan -> cut the whole range into equal, contiguous shards
+std::vector<ShardJob::Spec> ShardJob::plan(const Spec &whole, int shards) {
+	std::vector<Spec> specs;
+	long long total = whole.last - whole.first;
+	for (int i = 0; i < shards; ++i) {
+		Spec s = whole;
+		s.planFirst = whole.first;
+		s.planLast = whole.last;
+		s.first = whole.first + total * i / shards;
+		s.last = whole.first + total * (i + 1) / shards;
+		specs.push_back(s);
+	}
+	return specs;
+}
+
+bool ShardJob::saveCheckpoint(const std::string &path) const {
+	BinaryWriter w;
+	w.put<unsigned>(magic);
+	w.put<unsigned>(version);
+	w.put<int>(this->spec.kind);
+	w.putBytes(this->spec.paytable, sizeof(this->spec.paytable));
+	w.putString(this->spec.strategy);
+	w.put<unsigned long long>(this->spec.seed);
+	w.put<long long>(this->spec.first);
+	w.put<long long>(this->spec.last);
+	w.put<long long>(this->spec.planFirst);
+	w.put<long long>(this->spec.planLast);
+	w.put<long long>(this->next);
+	w.put<long long>(this->totals.optimal);
+	w.put<long long>(this->totals.strategy);
+	w.putBytes(this->totals.optimalCategories, sizeof(this->totals.optimalCategories));
+	w.putBytes(this->totals.strategyCategories, sizeof(this->totals.strategyCategories));
+	w.putChecksum();
+	return w.saveAtomically(path);
+}
+
+bool ShardJob::loadCheckpoint(const std::string &path, ShardJob &job, std::string &error) {
+	std::string buf;
+	if (!readFile(path, buf)) {
+		error = "can't open " + path;
+		return false;
+	}
+	BinaryReader r(buf);
+	if (r.get<unsigned>() != magic or r.get<unsigned>() != version) {
+		error = path + " isn't a version " + std::to_string(version) + " shard checkpoint";
+		return false;
+	}
+	Spec s;
+	s.kind = r.get<int>();
+	r.getBytes(s.paytable, sizeof(s.paytable));
+	s.strategy = r.getString();
+	s.seed = r.get<unsigned long long>();
+	s.first = r.get<long long>();
+	s.last = r.get<long long>();
+	s.planFirst = r.get<long long>();
+	s.planLast = r.get<long long>();
+	job = ShardJob(s);
+	job.next = r.get<long long>();
+	job.totals.optimal = r.get<long long>();
+	job.totals.strategy = r.get<long long>();
+	r.getBytes(job.totals.optimalCategories, sizeof(job.totals.optimalCategories));
+	r.getBytes(job.totals.strategyCategories, sizeof(job.totals.strategyCategories));
+	if (!r.verifyChecksum() or r.offset() != buf.size()) {
+		error = path + " is truncated or corrupted";
+		return false;
+	}
+	return true;
+}
+
+// run -> work through the rest of the range in blocks on the pool, checkpointing whenever everySeconds has gone by and
+// once more at the end. A block's totals only get added once the whole block is done, so a checkpoint never has half
+// a block in it. If a checkpoint can't be saved we stop there rather than go on with work that a kill would lose.
+bool ShardJob::run(WorkStealingPool &pool, const std::string &checkpoint, double everySeconds, std::string &error,
+		const std::function<void(long long, long long)> &progress) {
+	const long long block = 1 << 16, chunk = 1024;
+	DrawAnalyzer analyzer(this->spec.paytable, &pool);
+	HoldStrategy::Rule strategy = this->spec.strategy.empty() ? nullptr : HoldStrategy::byName(this->spec.strategy);
+	std::vector<std::unique_ptr<Totals>> perWorker = pool.perWorker<Totals>([]() { return new Totals; });
+	auto lastSave = std::chrono::steady_clock::now();
+	while (!done()) {
+		long long hi = std::min(this->spec.last, this->next + block);
+		pool.parallelFor(this->next, hi, chunk, [&](int worker, long long lo, long long end) {
+			Totals &t = *perWorker[worker];
+			DrawAnalyzer::HoldResult results[DrawAnalyzer::numHolds];
+			int hand[5];
+			for (long long d = lo; d < end; ++d) {
+				dealFor(this->spec, d, hand);
+				analyzer.analyze(hand, results);
+				const DrawAnalyzer::HoldResult &best = results[analyzer.bestHold(results)];
+				t.optimal += best.value;
+				for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+					t.optimalCategories[c] += best.counts[c] * (DrawAnalyzer::scale / best.draws);
+				}
+				if (strategy != nullptr) {
+					const DrawAnalyzer::HoldResult &played = results[strategy(hand)];
+					t.strategy += played.value;
+					for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+						t.strategyCategories[c] += played.counts[c] * (DrawAnalyzer::scale / played.draws);
+					}
+				}
+			}
+		});
+		for (std::size_t w = 0; w < perWorker.size(); ++w) {
+			this->totals.add(*perWorker[w]);
+			*perWorker[w] = Totals();
+		}
+		this->next = hi;
+		if (progress) {
+			progress(this->next - this->spec.first, this->spec.last - this->spec.first);
+		}
+		double since = std::chrono::duration<double>(std::chrono::steady_clock::now() - lastSave).count();
+		if (since >= everySeconds or done()) {
+			if (!saveCheckpoint(checkpoint)) {
+				error = "couldn't save the checkpoint to " + checkpoint;
+				return false;
+			}
+			lastSave = std::chrono::steady_clock::now();
+		}
+	}
+	if (!saveCheckpoint(checkpoint)) {  // also covers an already finished shard being run again
+		error = "couldn't save the checkpoint to " + checkpoint;
+		return false;
+	}
+	return true;
+}
+
+// merge -> the parts have to be finished shards of the same job whose ranges line up end to end with no gaps or overlap,
+// from the start of the plan's range to its end
+bool ShardJob::merge(const std::vector<ShardJob> &parts, ShardJob &merged, std::string &error) {
+	if (parts.empty()) {
+		error = "nothing to merge";
+		return false;
+	}
+	std::vector<ShardJob> sorted(parts);
+	std::sort(sorted.begin(), sorted.end(), [](const ShardJob &a, const ShardJob &b) {
+		return a.spec.first < b.spec.first;
+	});
+	Spec whole = sorted[0].spec;
+	whole.first = whole.planFirst;
+	whole.last = whole.planLast;
+	merged = ShardJob(whole);
+	for (std::size_t i = 0; i < sorted.size(); ++i) {
+		const ShardJob &part = sorted[i];
+		if (!part.spec.sameJob(whole)) {
+			error = "shards come from different jobs";
+			return false;
+		}
+		if (!part.done()) {
+			std::ostringstream msg;
+			msg << "shard [" << part.spec.first << ", " << part.spec.last << ") isn't finished";
+			error = msg.str();
+			return false;
+		}
+		long long expected = i > 0 ? sorted[i - 1].spec.last : whole.first;
+		if (part.spec.first != expected) {
+			std::ostringstream msg;
+			if (part.spec.first > expected) msg << "shards for [" << expected << ", " << part.spec.first << ") are missing";
+			else msg << "shards overlap at " << part.spec.first;
+			error = msg.str();
+			return false;
+		}
+		merged.totals.add(part.totals);
+	}
+	if (sorted.back().spec.last != whole.last) {
+		std::ostringstream msg;
+		msg << "shards for [" << sorted.back().spec.last << ", " << whole.last << ") are missing";
+		error = msg.str();
+		return false;
+	}
+	merged.next = whole.last;
+	return true;
+}
+
+#endif
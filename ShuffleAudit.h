@@ -0,0 +1,348 @@
+/*
+ * This class is the statistics behind the shuffle audit: does Deck::shuffle put every card in every spot equally often,
+ * with no card favouring any neighbour, and does the first five come out as each poker hand as often as it should?
+ * Shuffles are tallied into three sets of counts and each is tested against its exact expectation under a perfectly
+ * uniform shuffle:
+ *
+ *   position   - how often each card lands in each spot. Cards in one shuffle can't share a spot, so the counts aren't
+ *                independent and the statistic is matched to a scaled chi-square by its exact mean and variance (worked
+ *                out from the covariance of the counts). For a full deck that's exactly the chi-square statistic times
+ *                51/52 with 51^2 degrees of freedom.
+ *   adjacency  - how often card b comes right after card a, matched to a scaled chi-square the same way.
+ *   categories - the poker hand made by the first 5 cards against the 2,598,960 hand counts, with the rarest
+ *                categories pooled until every bin expects at least 5 hands.
+ *
+ * Deck::shuffle seeds from the clock every round. Reseeding from the real clock in a tight loop would only test how fast
+ * the loop runs (back to back shuffles get nearly the same seeds), so the deck source models the clock a live table sees
+ * instead: one reading per round, 2 to 30 seconds apart at nanosecond resolution, starting at a time drawn from the
+ * audit's seed. Results then depend only on --seed, not on timing or thread count, but the seeds come out about as good
+ * as random 32 bit numbers, so this assumes ideal seed entropy and says nothing about how guessable the real clock is.
+ *
+ * The stream source audits what the Game actually deals from with a DealStream: 10 cards per deal, taken from a seeded
+ * stream. Only those 10 spots are tallied.
+ *
+ * Shuffles are done on card ids instead of a deque of Cards. std::shuffle's swaps depend only on the engine and the
+ * length, so for the same seed the orders are the ones Deck::shuffle gives (matchesDeck() checks this), just a lot faster.
+ */
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef RANDOM_H
+#define RANDOM_H
+#include <random>
+#endif
+
+#ifndef CMATH_H
+#define CMATH_H
+#include <cmath>
+#endif
+
+#include "HandEval.h"
+#include "Deck.h"
+#include "DealStream.h"
+
+#ifndef SHUFFLEAUDIT_H
+#define SHUFFLEAUDIT_H
+
+class ShuffleAudit {
+	public:
+		static const int N = HandEval::numCards;
+		enum Source {
+			DECK,     // what Deck::shuffle does: a default_random_engine seeded from the clock (modelled, see above) every shuffle
+			SEEDED,   // the same engine and shuffle, but seeded once per block of shuffles, to audit them apart from the seeding
+			MT19937,  // std::mt19937 with std::shuffle, as a reference
+			STREAM    // the deals a DealStream hands the Game, one seeded stream per block
+		};
+		struct Tally {
+			unsigned long long shuffles{0};
+			int spots{N};                               // how many spots of each shuffle get tallied
+			unsigned long long position[N][N] = {{0}};  // [spot][card]
+			unsigned long long follows[N][N] = {{0}};   // [card][card right after it]
+			unsigned long long categories[HandEval::NUM_CATEGORIES] = {0};
+			char padding[64];  // keep neighbouring workers' tallies off of each other's cache lines
+			void add(const int order[]);
+			void merge(const Tally &other);
+		};
+		struct Test {
+			std::string name;
+			double stat, df, p;  // stat is already scaled to the chi-square distribution with df degrees of freedom
+		};
+	private:
+		template <typename Engine>
+		static void shuffleMany(Engine &rng, std::mt19937_64 *clock, long long count, Tally &t);
+		static double upperGamma(double a, double x);
+		static Test matched(const std::string &name, double stat, double cells, double mu, double clash, double chain,
+			double pChain, double apartTotal);
+	public:
+		static bool byName(const std::string &name, Source &source);
+		static void shuffleBlock(Source source, unsigned long long seed, long long block, long long count, Tally &t);
+		static bool matchesDeck(int trials);
+		static std::vector<Test> evaluate(const Tally &t);
+		static double chiSquareP(double stat, double df);
+		static double engineStateBits(Source source);
+		static int spotsFor(Source source) { return source == STREAM ? Deal::size : N; }
+};
+
+// add -> one shuffled deck's worth of counts, for its first `spots` cards
+void ShuffleAudit::Tally::add(const int order[]) {
+	for (int spot = 0; spot < this->spots; ++spot) {
+		++this->position[spot][order[spot]];
+	}
+	for (int spot = 0; spot + 1 < this->spots; ++spot) {
+		++this->follows[order[spot]][order[spot + 1]];
+	}
+	++this->categories[HandEval::category(order)];
+	++this->shuffles;
+}
+
+void ShuffleAudit::Tally::merge(const Tally &other) {
+	if (other.shuffles > 0) {
+		this->spots = other.spots;
+	}
+	this->shuffles += other.shuffles;
+	for (int i = 0; i < N; ++i) {
+		for (int j = 0; j < N; ++j) {
+			this->position[i][j] += other.position[i][j];
+			this->follows[i][j] += other.follows[i][j];
+		}
+	}
+	for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+		this->categories[c] += other.categories[c];
+	}
+}
+
+bool ShuffleAudit::byName(const std::string &name, Source &source) {
+	if (name == "deck") source = DECK;
+	else if (name == "seeded") source = SEEDED;
+	else if (name == "mt19937") source = MT19937;
+	else if (name == "stream") source = STREAM;
+	else return false;
+	return true;
+}
+
+// shuffleMany -> every shuffle starts from a fresh deck, so any bias shows up as is instead of averaging out over the
+// orders the previous rounds left behind. With a clock, every shuffle is reseeded from the next modelled clock reading.
+template <typename Engine>
+void ShuffleAudit::shuffleMany(Engine &rng, std::mt19937_64 *clock, long long count, Tally &t) {
+	const unsigned long long second = 1000000000ULL;
+	std::uniform_int_distribution<unsigned long long> gap(2 * second, 30 * second);
+	unsigned long long now = clock != nullptr ? (*clock)() : 0;  // nanoseconds since the epoch, as Deck::shuffle reads it
+	int order[N];
+	for (long long s = 0; s < count; ++s) {
+		if (clock != nullptr) {
+			now += gap(*clock);
+			rng.seed(unsigned(now));  // same truncation as Deck::shuffle()
+		}
+		for (int i = 0; i < N; ++i) {
+			order[i] = i;
+		}
+		std::shuffle(order, order + N, rng);
+		t.add(order);
+	}
+}
+
+// shuffleBlock -> `count` shuffles into the tally. Every source seeds from (seed, block) through a seed_seq so
+// neighbouring blocks don't get related streams, and a given block always shuffles the same way. For the deck source
+// that seed drives the modelled clock.
+void ShuffleAudit::shuffleBlock(Source source, unsigned long long seed, long long block, long long count, Tally &t) {
+	std::seed_seq seq{unsigned(seed), unsigned(seed >> 32), unsigned(block), unsigned(block >> 32)};
+	t.spots = spotsFor(source);
+	if (source == STREAM) {
+		unsigned words[2];
+		seq.generate(words, words + 2);
+		DealStream stream(1024, (unsigned long long)words[1] << 32 | words[0]);
+		for (long long s = 0; s < count; ++s) {
+			t.add(stream.nextDeal().cards);
+		}
+	}
+	else if (source == MT19937) {
+		std::mt19937 rng(seq);
+		shuffleMany(rng, nullptr, count, t);
+	}
+	else if (source == DECK) {
+		std::mt19937_64 clock(seq);
+		std::default_random_engine rng;
+		shuffleMany(rng, &clock, count, t);
+	}
+	else {
+		std::default_random_engine rng(seq);
+		shuffleMany(rng, nullptr, count, t);
+	}
+}
+
+// matchesDeck -> the shuffles we audit are the ones Deck::shuffle makes, for the first `trials` seeds
+bool ShuffleAudit::matchesDeck(int trials) {
+	for (int seed = 1; seed <= trials; ++seed) {
+		Deck deck;
+		deck.shuffle(seed);
+		std::deque<Card> cards = deck.getDeck();
+		int order[N];
+		for (int i = 0; i < N; ++i) {
+			order[i] = i;
+		}
+		std::default_random_engine rng(seed);
+		std::shuffle(order, order + N, rng);
+		for (int i = 0; i < N; ++i) {
+			if (HandEval::cardId(cards[i]) != order[i]) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// engineStateBits -> how many bits of state the source's engine has, which caps how many different orders it can deal
+double ShuffleAudit::engineStateBits(Source source) {
+	if (source == MT19937 or source == STREAM) {
+		return 19937;
+	}
+	return std::log2(double(std::default_random_engine::modulus - 1));
+}
+
+// upperGamma -> regularized upper incomplete gamma function Q(a, x): the series below a + 1, the continued fraction
+// (modified Lentz) above it
+double ShuffleAudit::upperGamma(double a, double x) {
+	if (x <= 0) {
+		return 1.0;
+	}
+	const double eps = 1e-15, tiny = 1e-300;
+	double front = std::exp(-x + a * std::log(x) - std::lgamma(a));
+	if (x < a + 1) {
+		double term = 1.0 / a, sum = term;
+		for (int n = 1; n < 100000 and std::fabs(term) > std::fabs(sum) * eps; ++n) {
+			term *= x / (a + n);
+			sum += term;
+		}
+		return std::max(0.0, 1.0 - sum * front);
+	}
+	double b = x + 1 - a, c = 1 / tiny, d = 1 / b, h = d;
+	for (int i = 1; i < 100000; ++i) {
+		double an = -i * (i - a);
+		b += 2;
+		d = an * d + b;
+		d = std::fabs(d) < tiny ? tiny : d;
+		c = b + an / c;
+		c = std::fabs(c) < tiny ? tiny : c;
+		d = 1 / d;
+		double delta = d * c;
+		h *= delta;
+		if (std::fabs(delta - 1) < eps) {
+			break;
+		}
+	}
+	return front * h;
+}
+
+// chiSquareP -> chance of a chi-square statistic at least this big
+double ShuffleAudit::chiSquareP(double stat, double df) {
+	return upperGamma(df / 2, stat / 2);
+}
+
+// matched -> a chi-square statistic over `cells` cells that each happen with probability mu per shuffle, matched to a
+// scaled chi-square by its exact mean and variance. Every cell has `clash` others it can never happen together with,
+// `chain` others it happens together with at probability pChain, and the rest add up to `apartTotal` (the sum of their
+// probabilities of happening together with it). The statistic is a quadratic form in counts that are close to normal,
+// so its variance is 2 tr((cov / mu)^2).
+ShuffleAudit::Test ShuffleAudit::matched(const std::string &name, double stat, double cells, double mu, double clash,
+		double chain, double pChain, double apartTotal) {
+	const double v0 = mu - mu * mu, v1 = -mu * mu, vc = pChain - mu * mu;
+	const double others = cells - 1 - clash - chain;
+	const double pApart = others > 0 ? apartTotal / others : 0.0, va = pApart - mu * mu;
+	const double mean = cells * v0 / mu;
+	const double variance = 2 * cells * (v0 * v0 + clash * v1 * v1 + chain * vc * vc + others * va * va) / (mu * mu);
+	const double scale = variance / (2 * mean), df = 2 * mean * mean / variance;
+	return Test{name, stat / scale, df, chiSquareP(stat / scale, df)};
+}
+
+// evaluate -> the tests, in the order described at the top
+std::vector<ShuffleAudit::Test> ShuffleAudit::evaluate(const Tally &t) {
+	std::vector<Test> tests;
+	const double n = t.shuffles;
+
+	// position: k spots by N cards, each cell expecting n / N. Per shuffle two cells can't both happen if they share a
+	// spot or a card, and any other two happen together with probability 1 / (N (N - 1)).
+	const int k = t.spots;
+	double e = n / N, stat = 0, worstP = 1, worstStat = 0;
+	int worstSpot = 0;
+	for (int spot = 0; spot < k; ++spot) {
+		double row = 0;
+		for (int card = 0; card < N; ++card) {
+			double d = t.position[spot][card] - e;
+			row += d * d / e;
+		}
+		stat += row;
+		double p = chiSquareP(row, N - 1);  // one spot on its own is an ordinary multinomial
+		if (p < worstP) {
+			worstP = p;
+			worstStat = row;
+			worstSpot = spot;
+		}
+	}
+	const double apart = 1.0 / (double(N) * (N - 1));
+	tests.push_back(matched("card by position", stat, double(k) * N, 1.0 / N, (N - 1) + (k - 1), 0, 0,
+		(k - 1) * double(N - 1) * apart));
+	tests.push_back(Test{"worst single position (#" + std::to_string(worstSpot + 1) + ", corrected for " +
+		std::to_string(k) + " looks)", worstStat, double(N - 1), 1 - std::pow(1 - worstP, k)});
+
+	// adjacency: N (N - 1) cells (a card never follows itself) over the m = k - 1 neighbouring pairs of a shuffle. Two
+	// cells can't both happen if they share the first card, share the second card, or are a and b swapped. a -> b and
+	// b -> c (or c -> a) can, as a run of three, and so can two pairs of 4 different cards.
+	const double m = k - 1, cells = double(N) * (N - 1), mu = m / cells;
+	const double pChain = (m - 1) / (cells * (N - 2)), pApart = (m - 1) * (m - 2) / (cells * (N - 2) * (N - 3));
+	e = n * mu;
+	stat = 0;
+	bool impossible = false;
+	for (int a = 0; a < N; ++a) {
+		for (int b = 0; b < N; ++b) {
+			if (a == b) {
+				impossible = impossible or t.follows[a][b] != 0;
+				continue;
+			}
+			double d = t.follows[a][b] - e;
+			stat += d * d / e;
+		}
+	}
+	Test adjacency = matched("pair adjacency", stat, cells, mu, 2.0 * N - 3, 2.0 * (N - 2), pChain,
+		(N - 2.0) * (N - 3) * pApart);
+	if (impossible) {
+		adjacency.p = 0.0;
+	}
+	tests.push_back(adjacency);
+
+	// categories: pool from the top down until a bin expects 5 hands, the leftovers go into the last full bin
+	long long counts[HandEval::NUM_CATEGORIES];
+	HandEval::standPatCounts(counts);
+	std::vector<double> expected, observed;
+	double pendingE = 0, pendingO = 0;
+	for (int c = HandEval::NUM_CATEGORIES - 1; c >= 0; --c) {
+		pendingE += n * counts[c] / 2598960.0;
+		pendingO += t.categories[c];
+		if (pendingE >= 5) {
+			expected.push_back(pendingE);
+			observed.push_back(pendingO);
+			pendingE = pendingO = 0;
+		}
+	}
+	if (!expected.empty()) {
+		expected.back() += pendingE;
+		observed.back() += pendingO;
+	}
+	stat = 0;
+	for (std::size_t i = 0; i < expected.size(); ++i) {
+		double d = observed[i] - expected[i];
+		stat += d * d / expected[i];
+	}
+	double bins = expected.size();
+	tests.push_back(Test{"hand categories (" + std::to_string(expected.size()) + " bins)", stat, bins - 1,
+		bins > 1 ? chiSquareP(stat, bins - 1) : 1.0});
+	return tests;
+}
+
+#endif
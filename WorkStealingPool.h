@@ -0,0 +1,365 @@
+/*
+ * This class is the shared thread pool for the big analysis runs (exhaustive RTP solving, strategy grading, shuffle
+ * audits). Each worker has its own deque of tasks: it pushes and pops its own work at the back and, once it runs dry,
+ * steals from the front of somebody else's deque. The chunks of an analysis are rarely the same size, so the workers that
+ * finish early keep busy with the others' leftovers instead of sitting at a barrier.
+ *
+ * Workers can optionally be pinned to a CPU each (Linux only), spread over the CPUs the process is allowed to run on.
+ * Per-worker state should be built with perWorker(), which runs the factory on the worker's own thread so the memory is
+ * first touched (and so placed on the NUMA node) where it will be used. parallelFor() splits a range into chunks and can
+ * report progress while it waits.
+ *
+ * parallelFor() and runOnEach() wait on a count of their own tasks only, so a task can call them too: a worker that
+ * waits runs whatever tasks it can take in the meantime instead of blocking its own thread. wait() is for the whole pool
+ * and can only be called from outside it.
+ */
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef DEQUE_H
+#define DEQUE_H
+#include <deque>
+#endif
+
+#ifndef MEMORY_H
+#define MEMORY_H
+#include <memory>
+#endif
+
+#ifndef FUNCTIONAL_H
+#define FUNCTIONAL_H
+#include <functional>
+#endif
+
+#ifndef ATOMIC_H
+#define ATOMIC_H
+#include <atomic>
+#endif
+
+#ifndef THREAD_H
+#define THREAD_H
+#include <thread>
+#endif
+
+#ifndef MUTEX_H
+#define MUTEX_H
+#include <mutex>
+#endif
+
+#ifndef CONDITION_VARIABLE_H
+#define CONDITION_VARIABLE_H
+#include <condition_variable>
+#endif
+
+#ifndef CHRONO_H
+#define CHRONO_H
+#include <chrono>
+#endif
+
+#ifndef IOSTREAM_H
+#define IOSTREAM_H
+#include <iostream>
+#endif
+
+#include <cassert>
+#include <cstring>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+class WorkStealingPool {
+	public:
+		typedef std::function<void(int)> Task;  // gets the id of the worker that runs it
+	private:
+		struct Worker {
+			std::mutex lock;
+			std::deque<Task> tasks;   // owner works at the back, thieves take from the front
+			std::deque<Task> pinned;  // tasks only this worker may run (see runOnEach)
+		};
+		std::vector<std::unique_ptr<Worker>> workers;
+		std::vector<std::thread> threads;
+		bool pin;
+		std::vector<int> cpus;              // the CPUs we may pin to, from sched_getaffinity
+		std::atomic<long long> queued{0};   // tasks sitting in deques
+		std::atomic<long long> pending{0};  // tasks submitted but not finished yet
+		std::atomic<unsigned> nextWorker{0};
+		bool stopping{false};
+		std::mutex idleLock, doneLock;
+		std::condition_variable idleCv, doneCv;
+		static int& currentWorker();
+		void pinToCpu(int id);
+		bool take(int id, Task &task);
+		void push(int id, Task task, bool onlyThisWorker);
+		void finished();
+		void finishedOne(std::atomic<long long> &left);
+		void waitFor(const std::atomic<long long> &left, const std::function<void()> &tick);
+		void run(int id);
+	public:
+		explicit WorkStealingPool(int numThreads = 0, bool pinThreads = false);
+		~WorkStealingPool();
+		WorkStealingPool(const WorkStealingPool&) = delete;
+		WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+		int size() const { return this->workers.size(); }
+		void submit(Task task);
+		void wait();  // call from outside the pool (asserted)
+		void runOnEach(const Task &task);
+		void parallelFor(long long begin, long long end, long long chunk,
+			const std::function<void(int, long long, long long)> &body,
+			const std::function<void(long long, long long)> &progress = nullptr);
+		template <typename T>
+		std::vector<std::unique_ptr<T>> perWorker(const std::function<T*()> &make);
+};
+
+// ctor -> 0 threads means one per hardware thread
+WorkStealingPool::WorkStealingPool(int numThreads, bool pinThreads): pin(pinThreads) {
+	if (numThreads <= 0) {
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	for (int i = 0; i < numThreads; ++i) {
+		this->workers.push_back(std::unique_ptr<Worker>(new Worker));
+	}
+#ifdef __linux__
+	cpu_set_t allowed;
+	if (this->pin and sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+		for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+			if (CPU_ISSET(cpu, &allowed)) {
+				this->cpus.push_back(cpu);
+			}
+		}
+	}
+#endif
+	for (int i = 0; i < numThreads; ++i) {
+		this->threads.push_back(std::thread(&WorkStealingPool::run, this, i));
+	}
+}
+
+// dtor -> finish whatever is left, then let the workers go
+WorkStealingPool::~WorkStealingPool() {
+	wait();
+	{
+		std::lock_guard<std::mutex> l(this->idleLock);
+		this->stopping = true;
+	}
+	this->idleCv.notify_all();
+	for (std::size_t i = 0; i < this->threads.size(); ++i) {
+		this->threads[i].join();
+	}
+}
+
+// currentWorker -> id of the worker running on this thread, or -1 outside the pool
+int& WorkStealingPool::currentWorker() {
+	static thread_local int id = -1;
+	return id;
+}
+
+// pinToCpu -> worker i goes on the i-th allowed CPU (wrapping around). A worker that can't be pinned says so and runs
+// unpinned.
+void WorkStealingPool::pinToCpu(int id) {
+#ifdef __linux__
+	if (this->cpus.empty()) {
+		std::cerr << "worker " << id << " not pinned: can't read the allowed CPUs" << std::endl;
+		return;
+	}
+	int cpu = this->cpus[id % this->cpus.size()];
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+	if (err != 0) {
+		std::cerr << "worker " << id << " not pinned to CPU " << cpu << ": " << std::strerror(err) << std::endl;
+	}
+#endif
+}
+
+// push -> the queued count goes up before we touch idleLock so a worker that's about to sleep can't miss it
+void WorkStealingPool::push(int id, Task task, bool onlyThisWorker) {
+	++this->pending;
+	{
+		std::lock_guard<std::mutex> l(this->workers[id]->lock);
+		if (onlyThisWorker) {
+			this->workers[id]->pinned.push_back(std::move(task));
+		}
+		else {
+			this->workers[id]->tasks.push_back(std::move(task));
+		}
+	}
+	++this->queued;
+	{
+		std::lock_guard<std::mutex> l(this->idleLock);
+	}
+	this->idleCv.notify_all();
+}
+
+// take -> own pinned work first, then own deque from the back (still hot in cache), then steal from the front of the
+// others' deques (the oldest and usually biggest pieces of work)
+bool WorkStealingPool::take(int id, Task &task) {
+	Worker &own = *this->workers[id];
+	{
+		std::lock_guard<std::mutex> l(own.lock);
+		if (!own.pinned.empty()) {
+			task = std::move(own.pinned.front());
+			own.pinned.pop_front();
+			--this->queued;
+			return true;
+		}
+		if (!own.tasks.empty()) {
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			--this->queued;
+			return true;
+		}
+	}
+	for (std::size_t i = 1; i < this->workers.size(); ++i) {
+		Worker &victim = *this->workers[(id + i) % this->workers.size()];
+		std::lock_guard<std::mutex> l(victim.lock);
+		if (!victim.tasks.empty()) {
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			--this->queued;
+			return true;
+		}
+	}
+	return false;
+}
+
+// finished -> a task is done, wake wait() if it was the last one in the pool
+void WorkStealingPool::finished() {
+	if (--this->pending == 0) {
+		std::lock_guard<std::mutex> l(this->doneLock);
+		this->doneCv.notify_all();
+	}
+}
+
+// finishedOne -> one of a parallelFor's (or runOnEach's) tasks is done, wake its caller if it was the last one. `left`
+// belongs to the caller and may be gone as soon as it hits 0, so it's not touched after that.
+void WorkStealingPool::finishedOne(std::atomic<long long> &left) {
+	if (--left == 0) {
+		std::lock_guard<std::mutex> l(this->doneLock);
+		this->doneCv.notify_all();
+	}
+}
+
+// waitFor -> wait until `left` is 0, calling tick about once a second. A worker keeps running tasks while it waits, so
+// nested calls can't tie up every thread, and only naps (briefly) when all it could take is already running elsewhere.
+void WorkStealingPool::waitFor(const std::atomic<long long> &left, const std::function<void()> &tick) {
+	const int id = currentWorker();
+	auto last = std::chrono::steady_clock::now();
+	std::unique_lock<std::mutex> l(this->doneLock, std::defer_lock);
+	while (left.load() > 0) {
+		Task task;
+		if (id >= 0 and take(id, task)) {
+			task(id);
+			finished();
+		}
+		else {
+			l.lock();
+			if (id >= 0) {
+				this->doneCv.wait_for(l, std::chrono::milliseconds(1), [&left] { return left.load() == 0; });
+			}
+			else {
+				this->doneCv.wait_for(l, std::chrono::seconds(1), [&left] { return left.load() == 0; });
+			}
+			l.unlock();
+		}
+		if (tick and std::chrono::steady_clock::now() - last >= std::chrono::seconds(1)) {
+			tick();
+			last = std::chrono::steady_clock::now();
+		}
+	}
+}
+
+// run -> worker loop. When there's nothing to take we sleep until something gets queued.
+void WorkStealingPool::run(int id) {
+	currentWorker() = id;
+	if (this->pin) {
+		pinToCpu(id);
+	}
+	while (true) {
+		Task task;
+		if (take(id, task)) {
+			task(id);
+			finished();
+			continue;
+		}
+		if (this->queued.load() > 0) {  // someone else's pinned task, let its owner get to it
+			std::this_thread::yield();
+			continue;
+		}
+		std::unique_lock<std::mutex> l(this->idleLock);
+		this->idleCv.wait(l, [this] { return this->stopping or this->queued.load() > 0; });
+		if (this->stopping and this->queued.load() == 0) {
+			return;
+		}
+	}
+}
+
+// submit -> a worker submitting keeps the task for itself (others can steal it), outside callers spread them round robin
+void WorkStealingPool::submit(Task task) {
+	int id = currentWorker();
+	if (id < 0) {
+		id = this->nextWorker++ % this->workers.size();
+	}
+	push(id, std::move(task), false);
+}
+
+// wait -> until every task in the pool is done. A worker calling this would be waiting on its own task.
+void WorkStealingPool::wait() {
+	assert(currentWorker() < 0);
+	std::unique_lock<std::mutex> l(this->doneLock);
+	this->doneCv.wait(l, [this] { return this->pending.load() == 0; });
+}
+
+// runOnEach -> run the task exactly once on every worker's own thread and wait for all of them
+void WorkStealingPool::runOnEach(const Task &task) {
+	std::atomic<long long> left(this->workers.size());
+	for (std::size_t i = 0; i < this->workers.size(); ++i) {
+		push(i, [this, &task, &left](int worker) {
+			task(worker);
+			finishedOne(left);
+		}, true);
+	}
+	waitFor(left, nullptr);
+}
+
+// parallelFor -> body(worker, lo, hi) over chunks of [begin, end). If there's a progress callback it gets called about
+// once a second with (items done, items total) while we wait, and once more at the end.
+void WorkStealingPool::parallelFor(long long begin, long long end, long long chunk,
+		const std::function<void(int, long long, long long)> &body,
+		const std::function<void(long long, long long)> &progress) {
+	std::atomic<long long> done(0), left((end - begin + chunk - 1) / chunk);
+	for (long long lo = begin; lo < end; lo += chunk) {
+		long long hi = std::min(end, lo + chunk);
+		submit([this, &body, &done, &left, lo, hi](int worker) {
+			body(worker, lo, hi);
+			done += hi - lo;
+			finishedOne(left);
+		});
+	}
+	waitFor(left, [&progress, &done, begin, end] {
+		if (progress) {
+			progress(done.load(), end - begin);
+		}
+	});
+	if (progress) {
+		progress(done.load(), end - begin);
+	}
+}
+
+// perWorker -> one T per worker, each made on its own worker's thread (first touch puts it on that worker's NUMA node)
+template <typename T>
+std::vector<std::unique_ptr<T>> WorkStealingPool::perWorker(const std::function<T*()> &make) {
+	std::vector<std::unique_ptr<T>> states(this->workers.size());
+	runOnEach([&states, &make](int worker) {
+		states[worker].reset(make());
+	});
+	return states;
+}
+
+#endif
@@ -0,0 +1,98 @@
+// driver for the shuffle audit (see ShuffleAudit.h). Shuffles run in blocks on the WorkStealingPool, each worker
+// tallying into its own counts, and the report at the end gives every test's statistic and p-value.
+// Usage: ./audit <deck|seeded|mt19937|stream> <shuffles> [--threads N] [--pin] [--seed S] [--report FILE]
+// A p-value under 0.001 fails the test. One over 0.999 is flagged too: a shuffle can also be suspiciously too even.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+#include "ShuffleAudit.h"
+#include "WorkStealingPool.h"
+
+int main(int argc, char* argv[]) {
+	int threads = 0;
+	bool pin = false;
+	unsigned long long seed = 1;
+	std::string reportFile;
+	ShuffleAudit::Source source;
+	bool usage = argc < 3 or !ShuffleAudit::byName(argv[1], source);
+	for (int i = 3; i < argc and !usage; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--threads" and i + 1 < argc) threads = std::atoi(argv[++i]);
+		else if (arg == "--pin") pin = true;
+		else if (arg == "--seed" and i + 1 < argc) seed = std::strtoull(argv[++i], nullptr, 10);
+		else if (arg == "--report" and i + 1 < argc) reportFile = argv[++i];
+		else usage = true;
+	}
+	if (usage) {
+		std::cout << "Usage: " << argv[0] << " <deck|seeded|mt19937|stream> <shuffles> [--threads N] [--pin] [--seed S] "
+			<< "[--report FILE]" << std::endl;
+		return 1;
+	}
+	long long shuffles = std::atof(argv[2]);  // so 1e9 works
+	if (!ShuffleAudit::matchesDeck(1000)) {
+		std::cout << "the audit's shuffles don't match Deck::shuffle any more, fix ShuffleAudit first" << std::endl;
+		return 1;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	WorkStealingPool pool(threads, pin);
+	std::vector<std::unique_ptr<ShuffleAudit::Tally>> tallies =
+		pool.perWorker<ShuffleAudit::Tally>([]() { return new ShuffleAudit::Tally; });
+	const long long block = 1 << 16;
+	pool.parallelFor(0, shuffles, block, [&](int worker, long long lo, long long hi) {
+		ShuffleAudit::shuffleBlock(source, seed, lo / block, hi - lo, *tallies[worker]);
+	}, [&start, source](long long done, long long total) {
+		double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cerr << "\r" << std::setw(3) << done * 100 / std::max(total, 1LL) << "% of shuffles, "
+			<< std::setprecision(3) << done * double(ShuffleAudit::spotsFor(source)) / secs / 1e6 << "M cards/s   " << std::flush;
+	});
+	std::cerr << std::endl;
+	double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	ShuffleAudit::Tally sum;
+	for (std::size_t w = 0; w < tallies.size(); ++w) {
+		sum.merge(*tallies[w]);
+	}
+	std::vector<ShuffleAudit::Test> tests = ShuffleAudit::evaluate(sum);
+
+	std::ostringstream report;
+	report << "Shuffle audit: " << argv[1] << ", seed " << seed
+		<< (source == ShuffleAudit::DECK ? " (reseeded every shuffle from a modelled clock, 2-30 s between rounds)" : "")
+		<< (source == ShuffleAudit::STREAM ? " (the first 10 cards of each deal a DealStream hands the Game)" : "")
+		<< "\n" << sum.shuffles << " shuffles, " << sum.shuffles * sum.spots << " cards in " << secs << " s ("
+		<< std::setprecision(4) << sum.shuffles * sum.spots / secs / 1e6 << "M cards/s on " << pool.size()
+		<< " threads)\n";
+	if (source == ShuffleAudit::DECK) {
+		report << "These results assume ideal seed entropy: readings of the modelled clock come out as good as random "
+			<< "32 bit seeds, so a pass here says nothing about seeding from the real clock.\n";
+	}
+	report << "\n";
+	bool passed = true;
+	for (std::size_t i = 0; i < tests.size(); ++i) {
+		const ShuffleAudit::Test &t = tests[i];
+		std::string verdict = t.p < 0.001 ? "FAIL" : t.p > 0.999 ? "too even" : "pass";
+		passed = passed and verdict == "pass";
+		report << std::left << std::setw(52) << t.name << std::right << " chi2 " << std::setw(12) << std::setprecision(8)
+			<< t.stat << "  df " << std::setw(9) << std::setprecision(6) << t.df << "  p " << std::setw(10)
+			<< std::setprecision(4) << t.p << "  " << verdict << "\n";
+	}
+	double bits = ShuffleAudit::engineStateBits(source);
+	report << "\nThe engine has " << std::setprecision(4) << bits << " bits of state, so it can deal at most 2^" << bits
+		<< " different orders. There are 52! (about 2^" << std::lgamma(53.0) / std::log(2.0) << ") of them.\n";
+	if (source == ShuffleAudit::DECK) {
+		report << "Deck::shuffle also seeds it from the clock, so anyone who knows roughly when a hand was shuffled "
+			<< "can narrow the deck down further. The tests above can't see that.\n";
+	}
+	report << (passed ? "All tests passed." : "Some tests did NOT pass.") << std::endl;
+
+	std::cout << report.str();
+	if (!reportFile.empty()) {
+		std::ofstream out(reportFile);
+		out << report.str();
+	}
+	return passed ? 0 : 2;
+}
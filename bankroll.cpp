@@ -0,0 +1,57 @@
+// driver for the BankrollAnalysis engine. Usage: ./bankroll <bankroll> <bet> <rounds> [payout file]
+// The payout file has one "multiplier probability" pair per line. Without one we use the exact stand pat distribution.
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+#include "BankrollAnalysis.h"
+
+int main(int argc, char* argv[]) {
+	if (argc < 4) {
+		std::cout << "Usage: " << argv[0] << " <bankroll> <bet> <rounds> [payout file]" << std::endl;
+		return 1;
+	}
+	long long bankroll = std::atoll(argv[1]);
+	long long bet = std::atoll(argv[2]);
+	long long rounds = std::atoll(argv[3]);
+	if (bet < 1 or bet > 5 or bankroll < 0 or rounds < 0) {
+		std::cout << "Bet needs to be between 1 and 5, bankroll and rounds can't be negative" << std::endl;
+		return 1;
+	}
+
+	std::map<int, double> payouts;
+	std::string error;
+	if (argc > 4) {
+		if (!BankrollAnalysis::loadPayouts(argv[4], payouts, error)) {
+			std::cout << error << std::endl;
+			std::cout << "Usage: " << argv[0] << " <bankroll> <bet> <rounds> [payout file]" << std::endl;
+			return 1;
+		}
+	}
+	else {
+		payouts = BankrollAnalysis::standPatPayouts();
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	BankrollAnalysis analysis(payouts);
+	BankrollAnalysis::Distribution net = analysis.netAfter(rounds);
+	BankrollAnalysis::RuinResult ruin = analysis.ruinAfter(bankroll / bet, rounds);
+	double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	long long spare = bankroll % bet;  // coins that can never be bet stay in the bankroll
+	std::cout << "Return per coin bet: " << analysis.expectedReturn() << std::endl;
+	std::cout << "\nAfter " << rounds << " rounds with unlimited credit (in coins):" << std::endl;
+	std::cout << "  mean net " << net.mean() * bet << ", std dev " << net.stddev() * bet << std::endl;
+	std::cout << "  5% / 50% / 95%: " << net.quantile(0.05) * bet << " / " << net.quantile(0.5) * bet << " / "
+		<< net.quantile(0.95) * bet << std::endl;
+	std::cout << "\nStarting with " << bankroll << " coins betting " << bet << " a round:" << std::endl;
+	std::cout << "  risk of ruin: " << ruin.riskOfRuin << std::endl;
+	if (ruin.survivors.mass() > 0) {
+		std::cout << "  survivors' bankroll mean " << ruin.survivors.mean() * bet + spare << ", 5% / 50% / 95%: "
+			<< ruin.survivors.quantile(0.05) * bet + spare << " / " << ruin.survivors.quantile(0.5) * bet + spare
+			<< " / " << ruin.survivors.quantile(0.95) * bet + spare << std::endl;
+	}
+	std::cout << "  probability trimmed off the tails: " << ruin.survivors.truncated + net.truncated << std::endl;
+	std::cout << "\nDone in " << secs << " s" << std::endl;
+	return 0;
+}
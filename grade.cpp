@@ -0,0 +1,235 @@
+// driver that grades hold policies against the optimal hold on every one of the 2,598,960 deals. All the policies are
+// graded in the same pass on the WorkStealingPool, so each deal's draw math is only done once. For every policy it
+// prints the exact return, how much each of its rules costs, and its costliest mistakes: which rule fired when which
+// hold was the best one, how often, what it costs, and the worst deal of each.
+// Usage: ./grade <policy file, built-in or builtin:NAME>... [--threads N] [--pin] [--top K]
+// A policy file is a list of rules (see HoldPolicy.h). The built-in strategies are the ones in HoldStrategy.h. A file
+// that exists wins over a built-in of the same name; builtin:NAME always means the built-in.
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include "DrawAnalyzer.h"
+#include "HoldPolicy.h"
+#include "HoldStrategy.h"
+#include "WorkStealingPool.h"
+
+// one policy, from a file or a built-in. Mistakes of a built-in are grouped by the hold it made instead of by rule.
+struct Graded {
+	std::string name;
+	HoldPolicy policy;
+	HoldStrategy::Rule builtIn{nullptr};
+	int groups() const { return this->builtIn != nullptr ? HoldPolicy::NUM_PATTERNS + 1 : this->policy.size() + 1; }
+};
+
+// Mistakes -> deals where one rule (or hold) was played and another hold was best. Losses are in units of 1 / scale.
+struct Mistakes {
+	long long deals{0}, loss{0}, worstLoss{0}, worstDeal{-1};
+	int worstHold{0}, bestHold{0};
+};
+
+// per-worker, per-policy running totals
+struct Totals {
+	long long value{0}, fired{0}, mistakes{0};
+	std::vector<long long> ruleFired, ruleLoss;  // by rule (or hold) played
+	std::vector<Mistakes> table;                 // [played * (NUM_PATTERNS + 1) + best hold's pattern]
+	char padding[64];
+	void init(int groups) {
+		this->ruleFired.assign(groups, 0);
+		this->ruleLoss.assign(groups, 0);
+		this->table.assign(groups * (HoldPolicy::NUM_PATTERNS + 1), Mistakes());
+	}
+};
+
+std::string showCard(int id) {
+	static const char* ranks[HandEval::numRanks] = {"A", "2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K"};
+	static const char suits[4] = {'h', 'c', 's', 'd'};
+	return ranks[HandEval::rank(id)] + std::string(1, suits[HandEval::suit(id)]);
+}
+
+// showHold -> the deal with the held cards in brackets
+std::string showHold(const int hand[5], int hold) {
+	std::string s;
+	for (int i = 0; i < 5; ++i) {
+		std::string c = showCard(hand[i]);
+		s += (i > 0 ? " " : "") + (hold >> i & 1 ? "[" + c + "]" : c);
+	}
+	return s;
+}
+
+int main(int argc, char* argv[]) {
+	int threads = 0, top = 10;
+	bool pin = false;
+	std::vector<Graded> graded;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i], error;
+		if (arg == "--threads" and i + 1 < argc) threads = std::atoi(argv[++i]);
+		else if (arg == "--pin") pin = true;
+		else if (arg == "--top" and i + 1 < argc) top = std::atoi(argv[++i]);
+		else if (arg.compare(0, 2, "--") == 0) {
+			graded.clear();
+			break;
+		}
+		else {
+			graded.push_back(Graded());
+			Graded &g = graded.back();
+			g.name = arg;
+			const std::string prefix = "builtin:";
+			if (arg.compare(0, prefix.size(), prefix) == 0) {
+				if ((g.builtIn = HoldStrategy::byName(arg.substr(prefix.size()))) == nullptr) {
+					std::cout << "no built-in strategy called " << arg.substr(prefix.size()) << std::endl;
+					return 1;
+				}
+			}
+			else if ((std::ifstream(arg) or (g.builtIn = HoldStrategy::byName(arg)) == nullptr)
+					and !g.policy.load(arg, error)) {
+				std::cout << error << std::endl;
+				return 1;
+			}
+		}
+	}
+	if (graded.empty()) {
+		std::cout << "Usage: " << argv[0] << " <policy file, built-in or builtin:NAME>... [--threads N] [--pin] [--top K]"
+			<< std::endl;
+		return 1;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	WorkStealingPool pool(threads, pin);
+	DrawAnalyzer analyzer(nullptr, &pool);  // the pool spreads the table over its workers' NUMA nodes
+	std::vector<std::unique_ptr<std::vector<Totals>>> totals = pool.perWorker<std::vector<Totals>>([&graded]() {
+		std::vector<Totals> *t = new std::vector<Totals>(graded.size());
+		for (std::size_t g = 0; g < graded.size(); ++g) {
+			(*t)[g].init(graded[g].groups());
+		}
+		return t;
+	});
+	std::vector<long long> optimal(pool.size(), 0);
+
+	pool.parallelFor(0, DrawAnalyzer::numDeals, 4096, [&](int worker, long long lo, long long hi) {
+		std::vector<Totals> &mine = *totals[worker];
+		DrawAnalyzer::HoldResult results[DrawAnalyzer::numHolds];
+		HoldPolicy::PatternSet sets[HoldPolicy::numHolds];
+		int hand[5];
+		DrawAnalyzer::unrankDeal(lo, hand);
+		for (long long d = lo; d < hi; ++d, DrawAnalyzer::nextDeal(hand)) {
+			analyzer.analyze(hand, results);
+			HoldPolicy::classifyHolds(hand, sets);
+			int best = analyzer.bestHold(results);
+			int bestClass = HoldPolicy::holdClass(sets[best]);
+			optimal[worker] += results[best].value;
+			for (std::size_t g = 0; g < graded.size(); ++g) {
+				Totals &t = mine[g];
+				int played, hold;
+				if (graded[g].builtIn != nullptr) {
+					hold = graded[g].builtIn(hand);
+					played = HoldPolicy::holdClass(sets[hold]);
+				}
+				else {
+					hold = graded[g].policy.choose(hand, sets, played);
+				}
+				long long loss = results[best].value - results[hold].value;
+				t.value += results[hold].value;
+				++t.ruleFired[played];
+				t.ruleLoss[played] += loss;
+				if (loss > 0) {
+					++t.mistakes;
+					Mistakes &m = t.table[played * (HoldPolicy::NUM_PATTERNS + 1) + bestClass];
+					++m.deals;
+					m.loss += loss;
+					if (loss > m.worstLoss) {  // deals go up within a chunk, so the first of equal losses stays
+						m.worstLoss = loss;
+						m.worstDeal = d;
+						m.worstHold = hold;
+						m.bestHold = best;
+					}
+				}
+			}
+		}
+	}, [](long long done, long long total) {
+		std::cerr << "\r" << std::setw(3) << done * 100 / total << "% of deals" << std::flush;
+	});
+	std::cerr << std::endl;
+
+	long long optimalValue = 0;
+	for (std::size_t w = 0; w < optimal.size(); ++w) {
+		optimalValue += optimal[w];
+	}
+	const double denom = double(DrawAnalyzer::scale) * DrawAnalyzer::numDeals;
+	std::cout << std::setprecision(6) << std::fixed;
+	std::cout << "Optimal return: " << optimalValue / denom << std::endl;
+
+	for (std::size_t g = 0; g < graded.size(); ++g) {
+		const int groups = graded[g].groups(), classes = HoldPolicy::NUM_PATTERNS + 1;
+		Totals sum;
+		sum.init(groups);
+		for (std::size_t w = 0; w < totals.size(); ++w) {
+			const Totals &t = (*totals[w])[g];
+			sum.value += t.value;
+			sum.mistakes += t.mistakes;
+			for (int r = 0; r < groups; ++r) {
+				sum.ruleFired[r] += t.ruleFired[r];
+				sum.ruleLoss[r] += t.ruleLoss[r];
+			}
+			for (int k = 0; k < groups * classes; ++k) {  // worst deal ties go to the lowest deal index
+				const Mistakes &m = t.table[k];
+				Mistakes &s = sum.table[k];
+				if (m.deals > 0 and (m.worstLoss > s.worstLoss or (m.worstLoss == s.worstLoss and m.worstDeal < s.worstDeal))) {
+					s.worstLoss = m.worstLoss;
+					s.worstDeal = m.worstDeal;
+					s.worstHold = m.worstHold;
+					s.bestHold = m.bestHold;
+				}
+				s.deals += m.deals;
+				s.loss += m.loss;
+			}
+		}
+		const bool builtIn = graded[g].builtIn != nullptr;
+		auto playedName = [&](int r) -> std::string {
+			if (builtIn) return std::string("held ") + HoldPolicy::name(r);
+			if (r == groups - 1) return "(no rule) discard all";
+			return "rule " + std::to_string(r + 1) + " \"" + graded[g].policy.rule(r).text + "\"";
+		};
+
+		std::cout << "\n" << graded[g].name << ": return " << sum.value / denom << ", costs "
+			<< (optimalValue - sum.value) / denom << " against optimal, " << std::setprecision(3)
+			<< 100.0 * sum.mistakes / DrawAnalyzer::numDeals << "% of deals played worse" << std::setprecision(6)
+			<< std::endl;
+		std::cout << "  " << std::left << std::setw(44) << (builtIn ? "hold" : "rule") << std::right << std::setw(10)
+			<< "deals" << std::setw(12) << "costs" << std::endl;
+		for (int r = 0; r < groups; ++r) {
+			if (sum.ruleFired[r] > 0 or !builtIn) {
+				std::cout << "  " << std::left << std::setw(44) << playedName(r) << std::right << std::setw(10)
+					<< sum.ruleFired[r] << std::setw(12) << sum.ruleLoss[r] / denom << std::endl;
+			}
+		}
+
+		std::vector<int> order;
+		for (int k = 0; k < groups * classes; ++k) {
+			if (sum.table[k].deals > 0) {
+				order.push_back(k);
+			}
+		}
+		std::sort(order.begin(), order.end(), [&sum](int a, int b) {
+			return sum.table[a].loss != sum.table[b].loss ? sum.table[a].loss > sum.table[b].loss : a < b;
+		});
+		std::cout << "  costliest mistakes:" << std::endl;
+		for (int i = 0; i < top and i < (int)order.size(); ++i) {
+			const Mistakes &m = sum.table[order[i]];
+			int hand[5];
+			DrawAnalyzer::unrankDeal(m.worstDeal, hand);
+			std::cout << "  " << std::setw(2) << i + 1 << ". " << playedName(order[i] / classes) << " when "
+				<< HoldPolicy::name(order[i] % classes) << " was best: " << m.deals << " deals, costs "
+				<< m.loss / denom << std::endl;
+			std::cout << "      worst: " << showHold(hand, m.worstHold) << " instead of " << showHold(hand, m.bestHold)
+				<< ", " << std::setprecision(4) << double(m.worstLoss) / DrawAnalyzer::scale << std::setprecision(6)
+				<< " coins per coin bet" << std::endl;
+		}
+	}
+	double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "\n" << pool.size() << " threads, " << std::setprecision(2) << secs << " s" << std::endl;
+	return 0;
+}
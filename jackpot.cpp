@@ -0,0 +1,107 @@
+// stress test for a shared progressive Jackpot. Usage: ./jackpot <jackpot file> <processes> <threads> <bets per thread>
+// Every thread bets 1-5 coins in a loop and hits a "royal flush" about once every 40,000 bets. Afterwards we check
+// that the jackpot's books match what the sessions themselves counted, to the thousandth of a coin. Running it again
+// on the same file carries on with the same pot.
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <sys/wait.h>
+#include "Jackpot.h"
+
+struct Counted {
+	long long betCoins{0}, wonCoins{0}, hits{0};
+};
+
+// play -> one process' worth of sessions. Returns what the sessions bet and won.
+Counted play(Jackpot &jackpot, int threads, long long bets, unsigned seed) {
+	std::vector<Counted> counted(threads);
+	std::vector<std::thread> sessions;
+	for (int t = 0; t < threads; ++t) {
+		sessions.push_back(std::thread([&jackpot, &counted, t, bets, seed]() {
+			std::mt19937 rng(seed * 1000 + t);
+			Counted c;
+			for (long long i = 0; i < bets; ++i) {
+				int bet = 1 + rng() % 5;
+				jackpot.contribute(bet);
+				c.betCoins += bet;
+				if (rng() % 40000 == 0) {
+					unsigned long long hit = 0;
+					c.wonCoins += jackpot.claim("session " + std::to_string(seed) + "." + std::to_string(t), &hit);
+					jackpot.credited(hit);
+					++c.hits;
+				}
+			}
+			counted[t] = c;
+		}));
+	}
+	Counted total;
+	for (int t = 0; t < threads; ++t) {
+		sessions[t].join();
+		total.betCoins += counted[t].betCoins;
+		total.wonCoins += counted[t].wonCoins;
+		total.hits += counted[t].hits;
+	}
+	return total;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 5) {
+		std::cout << "Usage: " << argv[0] << " <jackpot file> <processes> <threads> <bets per thread>" << std::endl;
+		return 1;
+	}
+	std::string path = argv[1], error;
+	int procs = std::atoi(argv[2]), threads = std::atoi(argv[3]);
+	long long bets = std::atoll(argv[4]);
+	const long long seedCoins = 4000, rate = 10;  // pot starts at 4000 coins, 1% of every bet goes in
+
+	std::unique_ptr<Jackpot> jackpot = Jackpot::open(path, seedCoins, rate, error);
+	if (!jackpot) {
+		std::cout << error << std::endl;
+		return 1;
+	}
+	Jackpot::Books before = jackpot->books();
+	auto start = std::chrono::steady_clock::now();
+	int pipes[2];
+	if (pipe(pipes) != 0) {
+		return 1;
+	}
+	for (int p = 0; p < procs; ++p) {
+		if (fork() == 0) {  // each child maps the same file on its own
+			std::unique_ptr<Jackpot> mine = Jackpot::open(path, seedCoins, rate, error);
+			Counted c = play(*mine, threads, bets, getpid());
+			if (write(pipes[1], &c, sizeof(c)) != sizeof(c)) {
+				_exit(1);
+			}
+			_exit(0);
+		}
+	}
+	Counted total;
+	for (int p = 0; p < procs; ++p) {
+		Counted c;
+		if (read(pipes[0], &c, sizeof(c)) == sizeof(c)) {
+			total.betCoins += c.betCoins;
+			total.wonCoins += c.wonCoins;
+			total.hits += c.hits;
+		}
+		wait(nullptr);
+	}
+	double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	Jackpot::Books after = jackpot->books();
+
+	long long contributed = after.contributed - before.contributed, paid = after.paid - before.paid;
+	bool ok = contributed == total.betCoins * rate and paid == total.wonCoins * Jackpot::milli
+		and after.hits - before.hits == total.hits
+		and after.pot == after.seeded + after.contributed - after.paid and after.lastCredited;
+	std::cout << procs * threads * bets << " bets in " << secs << " s (" << procs * threads * bets / secs / 1e6
+		<< " M/s), " << total.hits << " jackpots paying " << total.wonCoins << " coins" << std::endl;
+	std::cout << "Pot now " << jackpot->currentPot() << " coins after " << after.hits << " jackpots in total" << std::endl;
+	if (after.hits > 0) {
+		std::cout << "Last won by " << after.lastWinner << ": " << after.lastWin << " coins, "
+			<< (after.lastCredited ? "credited" : "NOT credited") << std::endl;
+	}
+	std::cout << (ok ? "Books balance" : "BOOKS DON'T BALANCE") << std::endl;
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,57 @@
+// driver for the RareEventEstimator. Usage: ./rare_event <royal|straightflush> <strategy> <naive|conditional|importance|all>
+//                                              [relative precision] [max samples] [seed]
+// The strategies are the HoldStrategy built-ins: standpat, discardall, simple, royalchaser
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+#include "RareEventEstimator.h"
+
+int main(int argc, char* argv[]) {
+	if (argc < 4) {
+		std::cout << "Usage: " << argv[0] << " <royal|straightflush> <strategy> <naive|conditional|importance|all>"
+			<< " [relative precision] [max samples] [seed]" << std::endl;
+		return 1;
+	}
+	std::string targetName = argv[1], modeName = argv[3];
+	int target;
+	if (targetName == "royal") target = HandEval::ROYAL_FLUSH;
+	else if (targetName == "straightflush") target = HandEval::STRAIGHT_FLUSH;
+	else {
+		std::cout << "Target has to be royal or straightflush" << std::endl;
+		return 1;
+	}
+	HoldStrategy::Rule strategy = HoldStrategy::byName(argv[2]);
+	if (strategy == nullptr) {
+		std::cout << "Unknown strategy " << argv[2] << std::endl;
+		return 1;
+	}
+	double precision = argc > 4 ? std::atof(argv[4]) : 0.05;
+	long long maxSamples = argc > 5 ? std::atof(argv[5]) : 1e8;  // so 1e8 works
+	unsigned long long seed = argc > 6 ? std::strtoull(argv[6], nullptr, 10) : 
+		std::chrono::system_clock::now().time_since_epoch().count();
+
+	const char* names[3] = {"naive", "conditional", "importance"};
+	for (int m = 0; m < 3; ++m) {
+		if (modeName != "all" and modeName != names[m]) {
+			continue;
+		}
+		auto start = std::chrono::steady_clock::now();
+		RareEventEstimator estimator(strategy, target, RareEventEstimator::Mode(m), seed);
+		RareEventEstimator::Estimate e = estimator.run(precision, maxSamples);
+		double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << names[m] << ": " << HandEval::name(target) << " frequency " << e.frequency << " +/- " << e.halfWidth()
+			<< " (95%) after " << e.samples << " hands (sized by a " << e.pilotSamples << " hand pilot run), " << secs << " s"
+			<< std::endl;
+		if (e.halfWidth() > precision * e.frequency) {
+			std::cout << "  WARNING: that's only +/-" << 100 * e.halfWidth() / std::max(e.frequency, 1e-300) << "%, not the +/-"
+				<< 100 * precision << "% asked for. About " << e.neededSamples << " hands would do it." << std::endl;
+		}
+		std::cout << "  contribution to return: " << e.frequency * HandEval::payout(target) << " per coin bet" << std::endl;
+		if (e.frequency > 0) {  // hands plain Monte Carlo would need for the same interval
+			double naive = 1.96 * 1.96 * (1 - e.frequency) / (precision * precision * e.frequency);
+			std::cout << "  naive Monte Carlo would need about " << naive << " hands" << std::endl;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,98 @@
+// driver for exhaustive RTP solving on the WorkStealingPool. Every one of the 2,598,960 deals is played with the best
+// possible hold (and optionally with a HoldStrategy too), so the return is exact, not an estimate.
+// Usage: ./rtp [--threads N] [--pin] [--strategy NAME] [--payouts FILE]
+// --payouts writes the optimal per-round payout distribution in the format the bankroll tool reads.
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+#include "DrawAnalyzer.h"
+#include "HoldStrategy.h"
+#include "WorkStealingPool.h"
+
+// per-worker running totals. Category totals are in units of 1 / scale of a deal so they stay whole numbers.
+struct Totals {
+	long long value{0}, strategyValue{0};
+	long long categories[HandEval::NUM_CATEGORIES] = {0};
+	char padding[64];  // keep neighbouring workers' totals off of each other's cache lines
+};
+
+int main(int argc, char* argv[]) {
+	int threads = 0;
+	bool pin = false;
+	HoldStrategy::Rule strategy = nullptr;
+	std::string strategyName, payoutFile;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--threads" and i + 1 < argc) threads = std::atoi(argv[++i]);
+		else if (arg == "--pin") pin = true;
+		else if (arg == "--strategy" and i + 1 < argc) strategyName = argv[++i];
+		else if (arg == "--payouts" and i + 1 < argc) payoutFile = argv[++i];
+		else {
+			std::cout << "Usage: " << argv[0] << " [--threads N] [--pin] [--strategy NAME] [--payouts FILE]" << std::endl;
+			return 1;
+		}
+	}
+	if (!strategyName.empty() and (strategy = HoldStrategy::byName(strategyName)) == nullptr) {
+		std::cout << "Unknown strategy " << strategyName << std::endl;
+		return 1;
+	}
+
+	WorkStealingPool pool(threads, pin);
+	auto start = std::chrono::steady_clock::now();
+	DrawAnalyzer analyzer(nullptr, &pool);  // the pool spreads the table over its workers' NUMA nodes
+	double built = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::vector<std::unique_ptr<Totals>> totals = pool.perWorker<Totals>([]() { return new Totals; });
+
+	pool.parallelFor(0, DrawAnalyzer::numDeals, 4096, [&](int worker, long long lo, long long hi) {
+		Totals &t = *totals[worker];
+		DrawAnalyzer::HoldResult results[DrawAnalyzer::numHolds];
+		int hand[5];
+		DrawAnalyzer::unrankDeal(lo, hand);
+		for (long long d = lo; d < hi; ++d, DrawAnalyzer::nextDeal(hand)) {
+			analyzer.analyze(hand, results);
+			const DrawAnalyzer::HoldResult &best = results[analyzer.bestHold(results)];
+			t.value += best.value;
+			for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+				t.categories[c] += best.counts[c] * (DrawAnalyzer::scale / best.draws);
+			}
+			if (strategy != nullptr) {
+				t.strategyValue += results[strategy(hand)].value;
+			}
+		}
+	}, [](long long done, long long total) {
+		std::cerr << "\r" << std::setw(3) << done * 100 / total << "% of deals" << std::flush;
+	});
+	std::cerr << std::endl;
+
+	Totals sum;
+	for (std::size_t w = 0; w < totals.size(); ++w) {
+		sum.value += totals[w]->value;
+		sum.strategyValue += totals[w]->strategyValue;
+		for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+			sum.categories[c] += totals[w]->categories[c];
+		}
+	}
+	const double denom = double(DrawAnalyzer::scale) * DrawAnalyzer::numDeals;
+	double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << std::setprecision(10);
+	std::cout << "Optimal return: " << sum.value / denom << " (" << sum.value << " / " << DrawAnalyzer::scale << " / "
+		<< DrawAnalyzer::numDeals << ")" << std::endl;
+	for (int c = HandEval::NUM_CATEGORIES - 1; c >= 0; --c) {
+		std::cout << "  " << std::setw(16) << std::left << HandEval::name(c) << std::right << sum.categories[c] / denom << std::endl;
+	}
+	if (strategy != nullptr) {
+		std::cout << strategyName << " return: " << sum.strategyValue / denom << std::endl;
+	}
+	if (!payoutFile.empty()) {
+		std::ofstream out(payoutFile);
+		out << std::setprecision(17);
+		for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+			out << HandEval::payout(c) << " " << sum.categories[c] / denom << "\n";
+		}
+	}
+	std::cout << pool.size() << " threads, " << built << " s building the table, " << secs << " s total" << std::endl;
+	return 0;
+}
@@ -0,0 +1,140 @@
+// driver for sharded, resumable analysis runs (see ShardJob.h)
+//   ./shard plan <shards> <prefix> [--sampled SAMPLES SEED] [--paytable p0 .. p9] [--strategy NAME]
+//        writes <prefix>-<i>.spec for every shard. Copy them wherever they should run.
+//   ./shard run <spec file> <checkpoint file> [--threads N] [--pin] [--every SECONDS]
+//        runs (or resumes) one shard, checkpointing every 60 seconds by default
+//   ./shard merge <checkpoint files...>
+//        checks that the shards fit together and prints the combined result
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+#include "ShardJob.h"
+
+void report(const ShardJob &job) {
+	const ShardJob::Spec &s = job.getSpec();
+	const ShardJob::Totals &t = job.getTotals();
+	long long count = job.getNext() - s.first;
+	double denom = double(DrawAnalyzer::scale) * count;
+	std::cout << std::setprecision(10);
+	std::cout << (s.kind == ShardJob::EXHAUSTIVE ? "Deals " : "Samples ") << s.first << " to " << job.getNext()
+		<< " of [" << s.first << ", " << s.last << ")" << std::endl;
+	if (count == 0) {
+		return;
+	}
+	std::cout << "Optimal return: " << t.optimal / denom << " (" << t.optimal << " / " << DrawAnalyzer::scale
+		<< " / " << count << ")" << std::endl;
+	for (int c = HandEval::NUM_CATEGORIES - 1; c >= 0; --c) {
+		std::cout << "  " << std::setw(16) << std::left << HandEval::name(c) << std::right
+			<< t.optimalCategories[c] / denom << std::endl;
+	}
+	if (!s.strategy.empty()) {
+		std::cout << s.strategy << " return: " << t.strategy / denom << " (" << t.strategy << " / "
+			<< DrawAnalyzer::scale << " / " << count << ")" << std::endl;
+	}
+}
+
+int usage(const char *name) {
+	std::cout << "Usage: " << name << " plan <shards> <prefix> [--sampled SAMPLES SEED] [--paytable p0 .. p9] [--strategy NAME]\n"
+		<< "       " << name << " run <spec file> <checkpoint file> [--threads N] [--pin] [--every SECONDS]\n"
+		<< "       " << name << " merge <checkpoint files...>" << std::endl;
+	return 1;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		return usage(argv[0]);
+	}
+	std::string command = argv[1], error;
+	if (command == "plan" and argc >= 4) {
+		int shards = std::atoi(argv[2]);
+		std::string prefix = argv[3];
+		ShardJob::Spec whole;
+		for (int i = 4; i < argc; ++i) {
+			std::string arg = argv[i];
+			if (arg == "--sampled" and i + 2 < argc) {
+				whole.kind = ShardJob::SAMPLED;
+				whole.last = std::atoll(argv[++i]);
+				whole.seed = std::strtoull(argv[++i], nullptr, 10);
+			}
+			else if (arg == "--paytable" and i + HandEval::NUM_CATEGORIES < argc) {
+				for (int c = 0; c < HandEval::NUM_CATEGORIES; ++c) {
+					whole.paytable[c] = std::atoi(argv[++i]);
+				}
+			}
+			else if (arg == "--strategy" and i + 1 < argc) whole.strategy = argv[++i];
+			else return usage(argv[0]);
+		}
+		if (shards < 1 or (!whole.strategy.empty() and HoldStrategy::byName(whole.strategy) == nullptr)) {
+			return usage(argv[0]);
+		}
+		std::vector<ShardJob::Spec> specs = ShardJob::plan(whole, shards);
+		for (std::size_t i = 0; i < specs.size(); ++i) {
+			std::string path = prefix + "-" + std::to_string(i) + ".spec";
+			if (!ShardJob::saveSpec(path, specs[i])) {
+				std::cout << "Couldn't write " << path << std::endl;
+				return 1;
+			}
+			std::cout << path << ": [" << specs[i].first << ", " << specs[i].last << ")" << std::endl;
+		}
+		return 0;
+	}
+	if (command == "run" and argc >= 4) {
+		int threads = 0;
+		bool pin = false;
+		double every = 60;
+		for (int i = 4; i < argc; ++i) {
+			std::string arg = argv[i];
+			if (arg == "--threads" and i + 1 < argc) threads = std::atoi(argv[++i]);
+			else if (arg == "--pin") pin = true;
+			else if (arg == "--every" and i + 1 < argc) every = std::atof(argv[++i]);
+			else return usage(argv[0]);
+		}
+		ShardJob::Spec spec;
+		if (!ShardJob::loadSpec(argv[2], spec, error)) {
+			std::cout << error << std::endl;
+			return 1;
+		}
+		ShardJob job(spec);
+		std::ifstream existing(argv[3]);
+		if (existing) {  // resume, but only if the checkpoint really belongs to this spec
+			if (!ShardJob::loadCheckpoint(argv[3], job, error)) {
+				std::cout << error << std::endl;
+				return 1;
+			}
+			if (!job.getSpec().sameJob(spec) or job.getSpec().first != spec.first or job.getSpec().last != spec.last) {
+				std::cout << argv[3] << " is a checkpoint for a different shard" << std::endl;
+				return 1;
+			}
+			std::cout << "Resuming at " << job.getNext() << std::endl;
+		}
+		WorkStealingPool pool(threads, pin);
+		bool saved = job.run(pool, argv[3], every, error, [](long long done, long long total) {
+			std::cerr << "\r" << std::setw(3) << (total > 0 ? done * 100 / total : 100) << "%" << std::flush;
+		});
+		std::cerr << std::endl;
+		if (!saved) {
+			std::cout << error << std::endl;
+			return 1;
+		}
+		report(job);
+		return 0;
+	}
+	if (command == "merge") {
+		std::vector<ShardJob> parts(argc - 2);
+		for (int i = 2; i < argc; ++i) {
+			if (!ShardJob::loadCheckpoint(argv[i], parts[i - 2], error)) {
+				std::cout << error << std::endl;
+				return 1;
+			}
+		}
+		ShardJob merged;
+		if (!ShardJob::merge(parts, merged, error)) {
+			std::cout << error << std::endl;
+			return 1;
+		}
+		report(merged);
+		return 0;
+	}
+	return usage(argv[0]);
+}
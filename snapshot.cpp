@@ -0,0 +1,163 @@
+// driver for SessionSnapshot. Usage:
+//   ./snapshot bench <sessions> [snapshot file]   -- times snapshotting and restoring that many sessions
+//   ./snapshot resume <snapshot file> [session]   -- picks one session of a snapshot back up and keeps playing
+// The bench spreads its sessions over every phase of a round (waiting for a bet, bet placed, dealt, drawn), checks that
+// restoring them and snapshotting again gives back the same bytes, that a corrupted snapshot is turned down, and that a
+// session that doesn't fit its phase is skipped while the others still come back.
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdlib>
+#include <chrono>
+#include "SessionSnapshot.h"
+
+// Quiet -> the sessions talk to the table (deals, goodbyes) as they would in a game; the bench doesn't need to hear it
+struct Quiet {
+	std::streambuf *old;
+	Quiet(): old(std::cout.rdbuf(nullptr)) {}
+	~Quiet() { std::cout.rdbuf(this->old); std::cout.clear(); }
+};
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int bench(int count, const std::string &path) {
+	std::vector<std::unique_ptr<Player>> players;
+	std::vector<std::unique_ptr<Deck>> decks;
+	std::vector<std::unique_ptr<Game>> owned;
+	std::vector<Game*> games;
+	{
+		Quiet quiet;
+		for (int i = 0; i < count; ++i) {
+			players.push_back(std::unique_ptr<Player>(new Player("Player " + std::to_string(i), 500 + i % 97)));
+			decks.push_back(std::unique_ptr<Deck>(new Deck));
+			owned.push_back(std::unique_ptr<Game>(new Game(players.back().get(), decks.back().get())));
+			Game &g = *owned.back();
+			players.back()->depositToBankroll(100 + i % 50);
+			if (i % 4 >= 1) {
+				g.placeBet(1 + i % 5);
+			}
+			if (i % 4 >= 2) {
+				g.dealCards();
+			}
+			if (i % 4 == 3) {
+				g.drawCards(std::vector<int>{1 + i % 5, 1 + (i / 5) % 5});
+			}
+			games.push_back(&g);
+		}
+	}
+
+	const int reps = 10;
+	BinaryWriter w;
+	auto start = std::chrono::steady_clock::now();
+	for (int rep = 0; rep < reps; ++rep) {
+		w = BinaryWriter();
+		SessionSnapshot::write(games, w);
+	}
+	double writeMs = millisSince(start) / reps;
+	const std::string &snap = w.data();
+
+	std::vector<SessionSnapshot::Session> restored;
+	std::vector<std::string> skipped;
+	std::string error;
+	double readMs = 0;
+	bool ok = true;
+	{
+		Quiet quiet;
+		for (int rep = 0; rep < reps and ok; ++rep) {
+			restored.clear();
+			start = std::chrono::steady_clock::now();
+			ok = SessionSnapshot::read(snap, restored, skipped, error) and skipped.empty();
+			readMs += millisSince(start) / reps;
+		}
+	}
+	if (!ok) {
+		std::cout << "restore failed: " << error << std::endl;
+		return 1;
+	}
+	std::cout << count << " sessions, " << snap.size() << " bytes (" << snap.size() / std::max(count, 1)
+		<< " per session)" << std::endl;
+	std::cout << "snapshot: " << writeMs << " ms, restore: " << readMs << " ms" << std::endl;
+
+	std::vector<Game*> again;
+	for (std::size_t i = 0; i < restored.size(); ++i) {
+		again.push_back(restored[i].game.get());
+	}
+	BinaryWriter w2;
+	SessionSnapshot::write(again, w2);
+	bool same = w2.data() == snap;
+	std::cout << "restored sessions snapshot to the same bytes: " << (same ? "yes" : "NO") << std::endl;
+
+	std::string corrupted = snap;
+	corrupted[corrupted.size() / 2] ^= 0x10;
+	std::vector<SessionSnapshot::Session> rejected;
+	bool caught = !SessionSnapshot::read(corrupted, rejected, skipped, error);
+	std::cout << "corrupted snapshot turned down: " << (caught ? "yes (" + error + ")" : "NO") << std::endl;
+
+	// session 0 is waiting for a bet with an empty hand. Claiming it's dealt (and fixing up the checksum) makes it bad.
+	std::string mismatched = snap.substr(0, snap.size() - sizeof(unsigned long long));
+	std::size_t phaseAt = 3 * sizeof(unsigned) + sizeof(unsigned) + players[0]->getName().size() + 4 * sizeof(int) + 1;
+	mismatched[phaseAt] = Game::DEALT;
+	unsigned long long sum = checksum(mismatched.data(), mismatched.size());
+	mismatched.append(reinterpret_cast<const char*>(&sum), sizeof(sum));
+	bool skippedOne = false;
+	{
+		Quiet quiet;
+		skippedOne = SessionSnapshot::read(mismatched, rejected, skipped, error) and skipped.size() == 1
+			and int(rejected.size()) == count - 1;
+		rejected.clear();
+	}
+	std::cout << "bad session skipped, the rest restored: " << (skippedOne ? "yes (" + skipped[0] + ")" : "NO")
+		<< std::endl;
+
+	if (!path.empty()) {
+		if (!SessionSnapshot::save(path, games)) {
+			std::cout << "can't write " << path << std::endl;
+			return 1;
+		}
+		std::cout << "saved to " << path << std::endl;
+	}
+	Quiet quiet;  // every Player says goodbye on the way out
+	restored.clear();
+	players.clear();
+	return same and caught and skippedOne ? 0 : 1;
+}
+
+int resume(const std::string &path, int index) {
+	std::vector<SessionSnapshot::Session> sessions;
+	std::vector<std::string> skipped;
+	std::string error;
+	if (!SessionSnapshot::load(path, sessions, skipped, error)) {
+		std::cout << error << std::endl;
+		return 1;
+	}
+	for (std::size_t i = 0; i < skipped.size(); ++i) {
+		std::cout << "skipped " << skipped[i] << std::endl;
+	}
+	if (index < 0 or index >= (int)sessions.size()) {
+		std::cout << path << " has " << sessions.size() << " sessions" << std::endl;
+		return 1;
+	}
+	static const char* phases[] = {"waiting for a bet", "bet placed", "dealt", "drawn"};
+	Game &game = *sessions[index].game;
+	std::cout << "Picking " << sessions[index].player->getName() << "'s session back up (" << phases[game.getPhase()]
+		<< ")" << std::endl;
+	sessions[index].player->display();
+	game.resumeGame();
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
+	std::string mode = argc > 1 ? argv[1] : "";
+	if (mode == "bench" and argc > 2) {
+		return bench(std::atoi(argv[2]), argc > 3 ? argv[3] : "");
+	}
+	if (mode == "resume" and argc > 2) {
+		return resume(argv[2], argc > 3 ? std::atoi(argv[3]) : 0);
+	}
+	std::cout << "Usage: " << argv[0] << " bench <sessions> [snapshot file]" << std::endl;
+	std::cout << "       " << argv[0] << " resume <snapshot file> [session]" << std::endl;
+	return 1;
+}
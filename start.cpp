@@ -1,13 +1,15 @@
 
 
-// driver that uses the Game class as the engine behind the scenes. We initialize a player with a savings of $500 and a deck. 
+// driver that uses the Game class as the engine behind the scenes. We initialize a player with a savings of $500 and a deck, 
+// which gets its deals from a DealStream. 
 #include <iostream>
 #include "Game.h"
 
 int main() {
 	Player tom("Tom", 500);
 	Deck deck; 
-	Game poker(&tom, &deck); 
+	DealStream stream;  // shuffles in the background while the player decides 
+	Game poker(&tom, &deck, &stream); 
 	poker.startGame();
 	return 0 ;
 }
@@ -0,0 +1,104 @@
+// checks and times the DealStream. Usage: ./stream [rounds]
+// Checks that a seeded stream is reproducible, that every deal is 10 different cards, that a full ring holds the
+// producer back, and that Deck::stack hands a deal out in order with all 52 cards still accounted for. Then it times a
+// round's deck work with the stream against Deck::resetDeck() + shuffle().
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include "Card.h"
+#include "Deck.h"
+#include "DealStream.h"
+
+bool check(bool ok, const std::string &what) {
+	std::cout << (ok ? "ok   " : "FAIL ") << what << std::endl;
+	return ok;
+}
+
+double nanosPerRound(std::chrono::steady_clock::time_point start, int rounds) {
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+int main(int argc, char* argv[]) {
+	int rounds = argc > 1 ? std::atoi(argv[1]) : 200000;
+	bool ok = true;
+
+	{
+		DealStream a(1024, 42), b(1024, 42), c(1024, 43);
+		bool same = true, differs = false, distinct = true;
+		for (int r = 0; r < rounds; ++r) {
+			Deal x = a.nextDeal(), y = b.nextDeal(), z = c.nextDeal();
+			bool seen[52] = {false};
+			for (int i = 0; i < Deal::size; ++i) {
+				same = same and x.cards[i] == y.cards[i];
+				differs = differs or x.cards[i] != z.cards[i];
+				distinct = distinct and x.cards[i] >= 0 and x.cards[i] < 52 and !seen[x.cards[i]];
+				seen[x.cards[i]] = true;
+			}
+		}
+		ok = check(same, "streams with the same seed deal the same") and ok;
+		ok = check(differs, "streams with different seeds don't") and ok;
+		ok = check(distinct, "every deal is 10 different cards") and ok;
+	}
+
+	{
+		DealStream s(64, 1);
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));  // nobody's taking deals, so the ring fills up
+		Deal d;
+		int ready = 0;
+		while (s.tryNextDeal(d)) {
+			++ready;
+		}
+		ok = check(ready == 64, "a full ring holds the producer at its capacity (" + std::to_string(ready) + " of 64)")
+			and ok;
+	}
+
+	{
+		DealStream s(1024, 7);
+		Deck deck;
+		bool inOrder = true, complete = true;
+		for (int r = 0; r < 1000; ++r) {
+			Deal d = s.nextDeal();
+			deck.stack(d.cards, Deal::size);
+			for (int i = 0; i < Deal::size; ++i) {
+				inOrder = inOrder and Deck::cardId(deck.deal()) == d.cards[i];
+			}
+			complete = complete and deck.countRemaining() == 52 - Deal::size;
+		}
+		deck.resetDeck();
+		bool seen[52] = {false};
+		std::deque<Card> cards = deck.getDeck();
+		for (std::size_t i = 0; i < cards.size(); ++i) {
+			complete = complete and !seen[Deck::cardId(cards[i])];
+			seen[Deck::cardId(cards[i])] = true;
+		}
+		ok = check(inOrder, "a stacked deck deals the stream's cards in order") and ok;
+		ok = check(complete and cards.size() == 52, "the deck still has each of the 52 cards once") and ok;
+	}
+
+	Deck deck;
+	DealStream s(1024, 9);
+	auto start = std::chrono::steady_clock::now();
+	for (int r = 0; r < rounds; ++r) {
+		Deal d = s.nextDeal();
+		deck.stack(d.cards, Deal::size);
+		for (int i = 0; i < Deal::size; ++i) {
+			deck.deal();
+		}
+	}
+	double streamed = nanosPerRound(start, rounds);
+	start = std::chrono::steady_clock::now();
+	for (int r = 0; r < rounds; ++r) {
+		deck.resetDeck();
+		deck.shuffle();
+		for (int i = 0; i < Deal::size; ++i) {
+			deck.deal();
+		}
+	}
+	double shuffled = nanosPerRound(start, rounds);
+	std::cout << "deck work per round (10 cards dealt): " << streamed << " ns from the stream, " << shuffled
+		<< " ns with resetDeck() + shuffle()" << std::endl;
+	return ok ? 0 : 1;
+}